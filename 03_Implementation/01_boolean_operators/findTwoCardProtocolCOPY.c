@@ -102,6 +102,28 @@ void __CPROVER_assert(int x, char y[]);
    */
 #ifndef SHUFFLE
 #define SHUFFLE 1
+#endif
+
+/**
+ * The first ACTION_PREFIX_LENGTH actions can be fixed to split one search into
+ * independent cubes. ACTION_PREFIX is read as a number in base A, its lowest
+ * digit is the first action. The caller states the base it used as
+ * ACTION_PREFIX_BASE, a prefix numbered in another base would fix other actions.
+ */
+#ifndef ACTION_PREFIX_LENGTH
+#define ACTION_PREFIX_LENGTH 0
+#endif
+
+#ifndef ACTION_PREFIX
+#define ACTION_PREFIX 0
+#endif
+
+#ifndef ACTION_PREFIX_BASE
+#define ACTION_PREFIX_BASE A
+#endif
+
+#if ACTION_PREFIX_LENGTH && ACTION_PREFIX_BASE != A
+#error "ACTION_PREFIX was numbered in another base than the number of action types A."
 #endif
 
    /**
@@ -171,6 +193,18 @@ void __CPROVER_assert(int x, char y[]);
 #define FORCE_RANDOM_CUTS 0
 #endif
 
+/**
+ * If set to 1, runs which have an equivalent shorter run are excluded before they reach the
+ * solver: shuffles which can be merged with the previous shuffle (see isMergeableShuffle),
+ * shuffles with only the identity and turns at positions whose symbol is already known.
+ * As identity shuffles can then no longer pad a protocol to L actions, a run ends at its first
+ * final state, so a run finds a protocol with at most L actions. This is sound, as every
+ * excluded protocol has an equivalent one with fewer actions which is found instead.
+ */
+#ifndef SYMMETRY_BREAKING
+#define SYMMETRY_BREAKING 0
+#endif
+
 /**
  * Maximum number of sequences (usually N!).
  * This value can be lowered if there are multiple indistinguishable symbols in the deck.
@@ -278,16 +312,11 @@ const unsigned int subgroupSizes[13] =
 #define MAX_TURN_OBSERVATIONS NUM_SYM
 #endif
 
-/**
- * The number of states stored in the protocol run (Start state + all L derived states).
- */
-#ifndef MAX_REACHABLE_STATES
-#define MAX_REACHABLE_STATES L+1
-#endif
+#include "../shared/compactBits.h"
 
 struct fraction {
-    unsigned int num; // The numerator.
-    unsigned int den; // The denominator.
+    probValue num; // The numerator.
+    probValue den; // The denominator.
 };
 
 struct fractions {
@@ -327,7 +356,7 @@ struct fractions {
  * Note that in this scenario, we have bool#1 == X_0 and bool#2 == X_1.
  */
 struct sequence {
-    unsigned int val[N];
+    cardValue val[N];
     struct fractions probs;
 };
 
@@ -340,23 +369,36 @@ struct state {
     struct sequence seq[NUMBER_POSSIBLE_SEQUENCES];
 };
 
+/**
+ * One permutation, as the sequence of the cards 1..N. It is not stored as a sequence,
+ * since its values exceed the card symbols if there are indistinguishable cards.
+ */
+struct permutationSequence {
+    unsigned int val[N];
+};
+
 /**
  * All permutations are remembered here, as seen from left to right, sorted alphabetically.
  */
 struct permutationState {
-    struct sequence seq[NUMBER_POSSIBLE_PERMUTATIONS];
+    struct permutationSequence seq[NUMBER_POSSIBLE_PERMUTATIONS];
 };
 
 /**
- * We use this struct to return arrays of states after turn operations.
- * There is one state for each possible observation.
- * In each turn, each sequence with an observable card #X is stored in
- * state X-1 and moreover isUsed[X-1] == 1 holds.
+ * We use this struct to return the observations of a turn operation at turnPosition.
+ * There is one branch for each possible observation.
+ * In each turn, each sequence with an observable card #X belongs to
+ * branch X-1 and moreover isUsed[X-1] == 1 holds.
  * If a card Y cannot be observed in the turn operation, then isUsed[Y-1] == 0 must hold.
+ * The state of a branch is only built if it is followed (see getObservationState).
+ * For probabilistic security, alignedProbs and alignedDenominator hold the factors which
+ * align the fractions of each used branch (see alignFractions).
  */
-struct turnStates {
-    struct state states[MAX_TURN_OBSERVATIONS];
+struct turnObservations {
+    positionValue turnPosition;
     unsigned int isUsed[MAX_TURN_OBSERVATIONS];
+    struct fractions alignedProbs[MAX_TURN_OBSERVATIONS];
+    unsigned int alignedDenominator[MAX_TURN_OBSERVATIONS];
 };
 
 /**
@@ -373,6 +415,9 @@ struct numsymarray {
     unsigned int arr[NUM_SYM];
 };
 
+#include "../shared/sequenceRanking.c"
+#include "../shared/generatedTables.h"
+
 /**
  * One bit is represented by two cards, a and b.
  * If the first card is lower than the second card, the bit represents the value "0"
@@ -408,7 +453,11 @@ struct state getEmptyState() {
             taken.arr[j] = 0;
         }
         for (unsigned int j = 0; j < N; j++) {
-            s.seq[i].val[j] = nondet_uint();
+#ifdef USE_SEQUENCE_TABLE
+            s.seq[i].val[j] = sequenceTable[i][j];
+#else
+            s.seq[i].val[j] = nondet_card();
+#endif
             unsigned int val = s.seq[i].val[j];
             assume (0 < val  && val <= NUM_SYM);
             unsigned int idx = val - 1;
@@ -509,16 +558,29 @@ unsigned int isStillPossible(struct fractions probs) {
 
 /**
  * Given an array containing a sequence, we return the index of the given sequence in a state.
+ * All states are sorted lexicographically, hence the index is the rank of the sequence.
  */
-unsigned int getSequenceIndexFromArray(struct narray compare, struct state compareState) {
-    unsigned int seqIdx = nondet_uint();
+unsigned int getSequenceIndexFromArray(struct narray compare) {
+    unsigned int seqIdx = getSequenceRank(compare.arr);
     assume (seqIdx < NUMBER_POSSIBLE_SEQUENCES);
-    struct sequence seq = compareState.seq[seqIdx];
+    return seqIdx;
+}
 
-    for (unsigned int i = 0; i < N; i++) {
-        assume (compare.arr[i] == seq.val[i]);
+/**
+ * Checks whether the given sequence consists of the same cards as the sequences in a state.
+ */
+unsigned int isSequenceOfDeck(struct narray compare) {
+    unsigned int res = 1;
+    for (unsigned int s = 1; s <= NUM_SYM; s++) {
+        unsigned int cnt = 0;
+        unsigned int deckCnt = 0;
+        for (unsigned int i = 0; i < N; i++) {
+            cnt += (compare.arr[i] == s);
+            deckCnt += (emptyState.seq[0].val[i] == s);
+        }
+        res &= (cnt == deckCnt);
     }
-    return seqIdx;
+    return res;
 }
 
 struct permutationState getStateWithAllPermutations() {
@@ -529,7 +591,11 @@ struct permutationState getStateWithAllPermutations() {
             taken.arr[j] = 0;
         }
         for (unsigned int j = 0; j < N; j++) {
+#ifdef USE_PERMUTATION_TABLE
+            s.seq[i].val[j] = permutationTable[i][j];
+#else
             s.seq[i].val[j] = nondet_uint();
+#endif
             unsigned int val = s.seq[i].val[j];
             assume (0 < val && val <= N);
             unsigned int idx = val - 1;
@@ -538,14 +604,6 @@ struct permutationState getStateWithAllPermutations() {
         }
     }
 
-    // Not needed, but to avoid state space explosion
-    for (unsigned int i = 0; i < NUMBER_POSSIBLE_PERMUTATIONS; i++) {
-        for (unsigned int j = 0; j < NUMBER_PROBABILITIES; j++) {
-            s.seq[i].probs.frac[j].num = 0;
-            s.seq[i].probs.frac[j].den = 1;
-        }
-    }
-
     for (unsigned int i = 1; i < NUMBER_POSSIBLE_PERMUTATIONS; i++) {
         unsigned int checked = 0;
         unsigned int last = i - 1;
@@ -661,8 +719,8 @@ unsigned int isFinalState(struct state s) {
          * (they need to have only two symbols, as otherwise we may be able to get information
          * from the output basis of the result bit).
          */
-        unsigned int a = nondet_uint(); // Index of the first card.
-        unsigned int b = nondet_uint(); // Index of the second card.
+        positionValue a = nondet_position(); // Index of the first card.
+        positionValue b = nondet_position(); // Index of the second card.
 
         assume (a < N && b < N && a != b);
         unsigned int lowerCard = 0;
@@ -721,10 +779,16 @@ unsigned int isFinalState(struct state s) {
     return res;
 }
 
+/**
+ * Number of 64-bit words of a membership bitset over all permutations.
+ */
+#define PERMUTATION_WORDS ((NUMBER_POSSIBLE_PERMUTATIONS + 63) / 64)
+
 /**
  * Check a permutation set whether it is closed under transitivity.
  */
-void checkTransitivityOfPermutation(unsigned int permutationSet[MAX_PERM_SET_SIZE][N],
+void checkTransitivityOfPermutation(positionValue permutationSet[MAX_PERM_SET_SIZE][N],
+                                    unsigned int permIndices[MAX_PERM_SET_SIZE],
                                     unsigned int permSetSize) {
     unsigned int onlyPerm = (permSetSize == 1);
 
@@ -769,6 +833,14 @@ void checkTransitivityOfPermutation(unsigned int permutationSet[MAX_PERM_SET_SIZ
         assume ((5 < N) || permittedSoubgroupSize);
 
         // hier hin der check, ob permSetSize eine Größe aus der obigen Liste hat
+
+        // Membership bitset of the permutation set, one bit per permutation index.
+        uint64_t members[PERMUTATION_WORDS] = { 0 };
+        for (unsigned int i = 0; i < MAX_PERM_SET_SIZE; i++) {
+            if (i < permSetSize) {
+                members[permIndices[i] / 64] |= (uint64_t)1 << (permIndices[i] % 64);
+            }
+        }
         for (unsigned int i = 0; i < MAX_PERM_SET_SIZE; i++) {
             if (i < permSetSize) {
                 for (unsigned int j = 0; j < MAX_PERM_SET_SIZE; j++) {
@@ -776,12 +848,12 @@ void checkTransitivityOfPermutation(unsigned int permutationSet[MAX_PERM_SET_SIZ
                         /**
                          * For every pair of permutations, check if the permutation that results
                          * from combining both permutations is contained in the permutation set.
-                         * The resulting permutation is determined nondeterministically. The
-                         * variables i and j are used to iterate over all permutations in the
+                         * The variables i and j are used to iterate over all permutations in the
                          * permutationSet. In fact this is a check for transitivity.
                          */
-                        unsigned int resultIdx = nondet_uint();
-                        assume (resultIdx < permSetSize);
+#ifdef USE_CAYLEY_TABLE
+                        unsigned int resultIdx = cayleyTable[permIndices[i]][permIndices[j]];
+#else
                         struct narray firstPermutation  = { .arr = { 0 } };
                         struct narray secondPermutation = { .arr = { 0 } };
 
@@ -792,10 +864,9 @@ void checkTransitivityOfPermutation(unsigned int permutationSet[MAX_PERM_SET_SIZ
 
                         struct narray permResultFromBothPerms =
                             combinePermutations(firstPermutation, secondPermutation);
-                        for (unsigned int k = 0; k < N; k++) {
-                            assume (   permResultFromBothPerms.arr[k]
-                                    == permutationSet[resultIdx][k]);
-                        }
+                        unsigned int resultIdx = getPermutationRank(permResultFromBothPerms.arr);
+#endif
+                        assume ((members[resultIdx / 64] >> (resultIdx % 64)) & 1);
                     }
                 }
             }
@@ -834,7 +905,8 @@ struct fractions recalculatePossibilities(struct fractions probs,
  * Calculate the state after a shuffle operation starting from s with the given permutation set.
  */
 struct state doShuffle(struct state s,
-                       unsigned int permutationSet[MAX_PERM_SET_SIZE][N],
+                       positionValue permutationSet[MAX_PERM_SET_SIZE][N],
+                       unsigned int permIndices[MAX_PERM_SET_SIZE],
                        unsigned int permSetSize) {
     struct state res = emptyState;
     // For every sequence in the input state.
@@ -843,13 +915,18 @@ struct state doShuffle(struct state s,
             // For every permutation in the permutation set.
             for (unsigned int j = 0; j < MAX_PERM_SET_SIZE; j++) {
                 if (j < permSetSize) {
+#ifdef USE_ACTION_TABLE
+                    // Look up the index of the sequence resulting from permutation j.
+                    unsigned int resultSeqIndex = actionTable[permIndices[j]][i];
+#else
                     struct narray resultingSeq = { .arr = { 0 } };
                     for (unsigned int k = 0; k < N; k++) {
                         // Apply permutation j to sequence i.
                         resultingSeq.arr[permutationSet[j][k]] = s.seq[i].val[k];
                     }
                     unsigned int resultSeqIndex = // Get the index of the resulting sequence.
-                        getSequenceIndexFromArray(resultingSeq, res);
+                        getSequenceIndexFromArray(resultingSeq);
+#endif
                     // Recalculate possibilities.
                     res.seq[resultSeqIndex].probs =
                         recalculatePossibilities(s.seq[i].probs,
@@ -862,16 +939,68 @@ struct state doShuffle(struct state s,
     return res;
 }
 
+/**
+ * The permutation set of a shuffle as a membership bitset, such that consecutive shuffles
+ * can be compared. A size of 0 denotes that the last action was no shuffle.
+ */
+struct shuffleSet {
+    uint64_t members[PERMUTATION_WORDS];
+    unsigned int size;
+};
+
+/**
+ * Returns 1 if the shuffle second directly after the shuffle first equals one shuffle which is
+ * searched as well. The composition of two uniform shuffles is uniform on the product of their
+ * permutation sets, hence:
+ *   - two single permutations compose to a single permutation,
+ *   - for closed shuffles, the product of two subgroups is in general no subgroup, but if one of
+ *     them contains the other permutation set, the product is this subgroup,
+ *   - for other shuffles, a single permutation and a shuffle compose to a shuffle with the same
+ *     number of permutations.
+ */
+unsigned int isMergeableShuffle(struct shuffleSet first, struct shuffleSet second) {
+    unsigned int firstInSecond = 1;
+    unsigned int secondInFirst = 1;
+    for (unsigned int i = 0; i < PERMUTATION_WORDS; i++) {
+        firstInSecond &= !(first.members[i] & ~second.members[i]);
+        secondInFirst &= !(second.members[i] & ~first.members[i]);
+    }
+    unsigned int merged = 0;
+    if (CLOSED_PROTOCOL || FORCE_RANDOM_CUTS) {
+        merged = (first.size == 1 && second.size == 1)
+                 || (firstInSecond && second.size > 1)
+                 || (secondInFirst && first.size > 1);
+    } else {
+        merged = (first.size == 1 || second.size == 1);
+    }
+    return first.size && merged;
+}
+
 /**
  * Generate a nondeterministic permutation set and apply it to the given state.
+ * With SYMMETRY_BREAKING, it must not be mergeable with lastShuffle, which it then replaces.
  */
-struct state applyShuffle(struct state s) {
+struct state applyShuffle(struct state s, struct shuffleSet *lastShuffle) {
     // Generate permutation set (shuffles are assumed to be uniformly distributed).
     unsigned int permSetSize = nondet_uint();
     assume (0 < permSetSize && permSetSize <= MAX_PERM_SET_SIZE);
 
-    unsigned int permutationSet[MAX_PERM_SET_SIZE][N] = { 0 };
+    /**
+     * Closed shuffles are exactly the subgroups of S_N. If the subgroup catalogue is available,
+     * we choose a subgroup by its index instead of checking closedness of the permutation set.
+     */
+    unsigned int useSubgroup = 0;
+#ifdef USE_SUBGROUP_TABLE
+    useSubgroup = (permSetSize != 1);
+    unsigned int subgroupIdx = nondet_uint();
+    assume (!useSubgroup || (subgroupIdx < NUMBER_SUBGROUPS
+                              && subgroupOrders[subgroupIdx] == permSetSize));
+#endif
+
+    positionValue permutationSet[MAX_PERM_SET_SIZE][N] = { 0 };
+    unsigned int permIndices[MAX_PERM_SET_SIZE] = { 0 };
     unsigned int takenPermutations[NUMBER_POSSIBLE_PERMUTATIONS] = { 0 };
+    struct shuffleSet shuffle = { .members = { 0 }, .size = permSetSize };
     /**
      * Choose permSetSize permutations nondeterministically. To achieve this,
      * generate a nondeterministic permutation index and get the permutation from this index.
@@ -881,6 +1010,11 @@ struct state applyShuffle(struct state s) {
     for (unsigned int i = 0; i < MAX_PERM_SET_SIZE; i++) {
         if (i < permSetSize) { // Only generate permutations up to permSetSize.
             unsigned int permIndex = nondet_uint();
+#ifdef USE_SUBGROUP_TABLE
+            if (useSubgroup) { // Subgroups are sorted and start with the identity.
+                permIndex = subgroupElements[subgroupOffsets[subgroupIdx] + i];
+            }
+#endif
             // This ensures that the permutation sets are sorted lexicographically.
             assume (lastChosenPermutationIndex <= permIndex);
             assume (permIndex < NUMBER_POSSIBLE_PERMUTATIONS);
@@ -888,6 +1022,10 @@ struct state applyShuffle(struct state s) {
 
             takenPermutations[permIndex] = 1;
             lastChosenPermutationIndex = permIndex;
+            permIndices[i] = permIndex;
+            if (SYMMETRY_BREAKING) {
+                shuffle.members[permIndex / 64] |= (uint64_t)1 << (permIndex % 64);
+            }
 
             for (unsigned int j = 0; j < N; j++) {
                 permutationSet[i][j] = stateWithAllPermutations.seq[permIndex].val[j] - 1;
@@ -900,22 +1038,33 @@ struct state applyShuffle(struct state s) {
         }
     }
 
-    if (CLOSED_PROTOCOL || FORCE_RANDOM_CUTS) { // Check for closedness.
-        checkTransitivityOfPermutation(permutationSet, permSetSize);
+    if ((CLOSED_PROTOCOL || FORCE_RANDOM_CUTS) && !useSubgroup) { // Check for closedness.
+        checkTransitivityOfPermutation(permutationSet, permIndices, permSetSize);
         // As in state trees, we want to include the identity if it is not a permutation.
         assume (permSetSize == 1 || takenPermutations[0] > 0);
     }
+    if (SYMMETRY_BREAKING) {
+        // A shuffle with only the identity does not change the state.
+        assume (permSetSize > 1 || permIndices[0] != 0);
+        assume (!isMergeableShuffle(*lastShuffle, shuffle));
+        *lastShuffle = shuffle;
+    }
     // Apply the shuffle that was generated above.
-    struct state res = doShuffle(s, permutationSet, permSetSize);
+    struct state res = doShuffle(s, permutationSet, permIndices, permSetSize);
 
     assume (isBottomFree(res));
     return res;
 }
 
-struct turnStates alignAndAssignFractions(struct turnStates result,
-                                          struct fractions probs) {
+/**
+ * Align the fractions of every used branch of a turn to the same denominator, such that its
+ * possibilities sum up to 1 again. The sums probs are aligned once for every used branch in
+ * turn, and the factors of each branch are stored in the turn, so that the branches are
+ * aligned once per turn, however many of them are built.
+ */
+struct turnObservations alignFractions(struct turnObservations turn, struct fractions probs) {
     for (unsigned int i = 0; i < MAX_TURN_OBSERVATIONS; i++) {
-        if (result.isUsed[i]) {
+        if (turn.isUsed[i]) {
             unsigned int newDenominator = 1;
             /**
              * Align all fractions to the same denominator,
@@ -933,19 +1082,18 @@ struct turnStates alignAndAssignFractions(struct turnStates result,
                 assume (probs.frac[j].num == probs.frac[0].num);
                 newDenominator *= probs.frac[j].den;
             }
-            // Update fractions in result state.
-            for (unsigned int j = 0; j < NUMBER_POSSIBLE_SEQUENCES; j++) {
-                for (unsigned int k = 0; k < NUMBER_PROBABILITIES; k++) {
-                    result.states[i].seq[j].probs.frac[k].num *= newDenominator;
-                    result.states[i].seq[j].probs.frac[k].den *= probs.frac[k].num;
-                }
-            }
+            turn.alignedProbs[i] = probs;
+            turn.alignedDenominator[i] = newDenominator;
         }
     }
-    return result;
+    return turn;
 }
 
-struct fractions computeTurnProbabilities(struct turnStates result) {
+/**
+ * Add up the possibilities of all branches of a turn, which are the ones of all sequences
+ * of s that are still possible, in the order of the branches.
+ */
+struct fractions computeTurnProbabilities(struct state s, struct turnObservations turn) {
     struct fractions probs;
     for (unsigned int i = 0; i < NUMBER_PROBABILITIES; i++) {
         probs.frac[i].num = 0;
@@ -953,12 +1101,12 @@ struct fractions computeTurnProbabilities(struct turnStates result) {
         probs.frac[i].den = 1;
     }
     for (unsigned int i = 0; i < MAX_TURN_OBSERVATIONS; i++) {
-        if (result.isUsed[i]) { // Only recalculate states that are used later.
-            struct state resultState = result.states[i];
+        if (turn.isUsed[i]) { // Only recalculate states that are used later.
             // Add up all possibilities in a state.
             for (unsigned int j = 0; j < NUMBER_POSSIBLE_SEQUENCES; j++) {
-                struct sequence resultSeq = resultState.seq[j];
-                if (isStillPossible(resultSeq.probs)) {
+                struct sequence resultSeq = s.seq[j];
+                if (   isStillPossible(resultSeq.probs)
+                    && resultSeq.val[turn.turnPosition] == i + 1) {
                     for (unsigned int k = 0; k < NUMBER_PROBABILITIES; k++) {
                         struct fraction prob = resultSeq.probs.frac[k];
                         unsigned int num   = prob.num;
@@ -985,20 +1133,16 @@ struct fractions computeTurnProbabilities(struct turnStates result) {
 
 /**
  * Given state and the position of a turned card,
- * this function returns all branched states resulting from the turn.
+ * this function returns which observations the turn can result in.
  */
-struct turnStates copyObservations(struct state s, unsigned int turnPosition) {
-    struct turnStates result;
-    // Initialise N empty states.
+struct turnObservations copyObservations(struct state s, positionValue turnPosition) {
+    struct turnObservations result;
+    result.turnPosition = turnPosition;
     for (unsigned int i = 0; i < MAX_TURN_OBSERVATIONS; i++) {
-        result.states[i] = emptyState;
         result.isUsed[i] = 0;
     }
     unsigned int cntTurnObservations = 0;
-    /**
-     * If a sequence belongs to an observation X, then copy this
-     * sequence into the state of observation X.
-     */
+    // If a sequence belongs to an observation X, then observation X is used.
     for (unsigned int i = 0; i < NUMBER_POSSIBLE_SEQUENCES; i++) {
         struct sequence seq = s.seq[i];
         if (isStillPossible(seq.probs)) {
@@ -1007,50 +1151,83 @@ struct turnStates copyObservations(struct state s, unsigned int turnPosition) {
             cntTurnObservations += result.isUsed[turnIdx] ? 0 : 1;
             result.isUsed[turnIdx] = 1;
             assume (cntTurnObservations <= MAX_TURN_OBSERVATIONS);
+        }
+    }
+    assume (MIN_TURN_OBSERVATIONS <= cntTurnObservations);
+    // A turn at a position whose symbol is already known does not branch.
+    assume (!SYMMETRY_BREAKING || 2 <= cntTurnObservations);
+    return result;
+}
+
+/**
+ * Returns the branched state of a turn in which the card observation + 1 is observed.
+ * Only this state is built, such that a protocol run stores one state per step. Its fractions
+ * are aligned with the factors which applyTurn stored for this branch.
+ */
+struct state getObservationState(struct state s, struct turnObservations turn,
+                                 unsigned int observation) {
+    struct state result = emptyState;
+    /**
+     * If a sequence belongs to the observation, then copy this
+     * sequence into the state of the observation.
+     */
+    for (unsigned int i = 0; i < NUMBER_POSSIBLE_SEQUENCES; i++) {
+        struct sequence seq = s.seq[i];
+        if (isStillPossible(seq.probs) && seq.val[turn.turnPosition] == observation + 1) {
             for (unsigned int j = 0; j < NUMBER_PROBABILITIES; j++) {
                 struct fraction prob = seq.probs.frac[j];
                 // Copy numerator.
-                result.states[turnIdx].seq[i].probs.frac[j].num = prob.num;
+                result.seq[i].probs.frac[j].num = prob.num;
                 if (!WEAK_SECURITY) { // Probabilistic security
                     // Copy denominator.
-                    result.states[turnIdx].seq[i].probs.frac[j].den = prob.den;
+                    result.seq[i].probs.frac[j].den = prob.den;
                 }
             }
         }
     }
-    assume (MIN_TURN_OBSERVATIONS <= cntTurnObservations);
+    if (!WEAK_SECURITY) { // Probabilistic security.
+        // Update fractions in result state.
+        struct fractions probs = turn.alignedProbs[observation];
+        unsigned int denominator = turn.alignedDenominator[observation];
+        for (unsigned int j = 0; j < NUMBER_POSSIBLE_SEQUENCES; j++) {
+            for (unsigned int k = 0; k < NUMBER_PROBABILITIES; k++) {
+                result.seq[j].probs.frac[k].num *= denominator;
+                result.seq[j].probs.frac[k].den *= probs.frac[k].num;
+            }
+        }
+    }
     return result;
 }
 
 /**
- * Turn at a nondeterministic position and return all resulting states. For each possible
- * observation, there is a distinct state. If an observation cannot occur through this
+ * Turn at a nondeterministic position and return its observations. For each possible
+ * observation, there is a distinct branch. If an observation cannot occur through this
  * turn operation, the according isUsed entry is set to zero. For more information, refer
- * to the documentation of "turnStates".
+ * to the documentation of "turnObservations".
  */
-struct turnStates applyTurn(struct state s) {
+struct turnObservations applyTurn(struct state s) {
     // Choose turn position nondeterministically, otherwise we cannot do two turns in a row.
-    unsigned int turnPosition = nondet_uint();
+    positionValue turnPosition = nondet_position();
     assume (turnPosition < N);
 
-    struct turnStates result = copyObservations(s, turnPosition);
-    if (WEAK_SECURITY) { // Weaker security check: output-possibilistic or input-possibilistic.
+    struct turnObservations result = copyObservations(s, turnPosition);
+    if (!WEAK_SECURITY) { // Probabilistic security.
+        result = alignFractions(result, computeTurnProbabilities(s, result));
+    } else { // Weaker security check: output-possibilistic or input-possibilistic.
         for (unsigned int stateNumber = 0; stateNumber < MAX_TURN_OBSERVATIONS; stateNumber++) {
             if (result.isUsed[stateNumber]) {
-                struct state resultState = result.states[stateNumber];
                 // Now nondeterministic. We only need to find one sequence for
                 // every possible in-/output. We assume nondeterministically
-                // that the state contains a sequence for every in-/output possibility.
+                // that the branch contains a sequence for every in-/output possibility.
                 for (unsigned int i = 0; i < NUMBER_PROBABILITIES; i++) {
                     unsigned int seqIndex = nondet_uint();
                     assume (seqIndex < NUMBER_POSSIBLE_SEQUENCES);
-                    assume (resultState.seq[seqIndex].probs.frac[i].num);
+                    struct sequence seq = s.seq[seqIndex];
+                    assume (seq.val[turnPosition] == stateNumber + 1);
+                    assume (seq.probs.frac[i].num);
                 }
             }
         }
-    } else { // Probabilistic security.
-        struct fractions probs = computeTurnProbabilities(result);
-        result = alignAndAssignFractions(result, probs);
     }
 
     return result;
@@ -1074,17 +1251,23 @@ struct turnStates applyTurn(struct state s) {
 unsigned int performActions(struct state s) {
     unsigned int result = 0;
 
-    // All reachable states are stored here.
-    struct state reachableStates[MAX_REACHABLE_STATES];
-    for (unsigned int i = 0; i < MAX_REACHABLE_STATES; i++) {
-        // Begin calculation from start state.
-        reachableStates[i] = s;
-    }
+    // Only the current state is stored, every action replaces it by its chosen successor.
+    struct state current = s;
+    // The last shuffle and the positions turned since the cards last moved, see SYMMETRY_BREAKING.
+    struct shuffleSet lastShuffle = { .members = { 0 }, .size = 0 };
+    unsigned int turnedPositions = 0;
+
+    unsigned int actionPrefix = ACTION_PREFIX;
 
     for (unsigned int i = 0; i < L; i++) {
         // Choose the action nondeterministically.
         unsigned int action = nondet_uint();
         assume(action < A);
+        if (i < ACTION_PREFIX_LENGTH) {
+            // The action is given by the cube of a split search.
+            assume(action == actionPrefix % A);
+            actionPrefix /= A;
+        }
         // If A is greater than 2, we must add cases for additional actions below.
         if (MODULES == 0) {
             assume(A == 2);
@@ -1096,11 +1279,17 @@ unsigned int performActions(struct state s) {
 
         if (action == TURN) {
             /**
-             * Generate N states through a turn operation and store them in the
-             * reachableStates array. For every used state, we get another path
-             * in the protocol that must be processed.
+             * Turn a card. For every used observation, we get another path
+             * in the protocol that must be processed, but only the state of
+             * the followed branch is kept (all used ones are checked for finite runtime).
              */
-            struct turnStates possiblePostStates = applyTurn(reachableStates[i]);
+            struct turnObservations turn = applyTurn(current);
+            if (SYMMETRY_BREAKING) {
+                // A turned card stays known until the cards are moved again.
+                assume(!((turnedPositions >> turn.turnPosition) & 1));
+                turnedPositions |= 1u << turn.turnPosition;
+                lastShuffle.size = 0;
+            }
 
             /**
             * We decide on one branch to look at further.
@@ -1109,46 +1298,60 @@ unsigned int performActions(struct state s) {
             */
             unsigned int stateIdx = nondet_uint();
             assume(stateIdx < MAX_TURN_OBSERVATIONS);
-            assume(possiblePostStates.isUsed[stateIdx]);
-            reachableStates[next] = possiblePostStates.states[stateIdx];
+            assume(turn.isUsed[stateIdx]);
+            struct state successor = current;
             if (!FINITE_RUNTIME) { // Restart-free Las-Vegas.
-                if (isFinalState(reachableStates[next])) {
-                    assume(next == L);
+                successor = getObservationState(current, turn, stateIdx);
+                if (isFinalState(successor)) {
+                    assume(SYMMETRY_BREAKING || next == L);
                     result = 1;
+                    break;
                 }
             }
             else {
                 unsigned int isFinalTurn = 1;
+                // Every used branch is built once, the followed one is the successor.
                 for (unsigned int j = 0; j < MAX_TURN_OBSERVATIONS; j++) {
-                    if (possiblePostStates.isUsed[j]
-                        && !isFinalState(possiblePostStates.states[j])) {
-                        isFinalTurn = 0;
+                    if (turn.isUsed[j]) {
+                        struct state branch = getObservationState(current, turn, j);
+                        if (!isFinalState(branch)) {
+                            isFinalTurn = 0;
+                        }
+                        if (j == stateIdx) {
+                            successor = branch;
+                        }
                     }
                 }
                 if (isFinalTurn) {
-                    assume(next == L);
+                    assume(SYMMETRY_BREAKING || next == L);
                     result = 1;
+                    break;
                 }
             }
+            current = successor;
         }
         else if (action == SHUFFLE) {
             /**
-             * Apply a nondet shuffle and store the result in
-             * the reachableStates array.
+             * Apply a nondet shuffle, its result is the new current state.
              */
-            reachableStates[next] = applyShuffle(reachableStates[i]);
-            if (isFinalState(reachableStates[next])) {
-                assume(next == L);
+            current = applyShuffle(current, &lastShuffle);
+            turnedPositions = 0;
+            if (isFinalState(current)) {
+                assume(SYMMETRY_BREAKING || next == L);
                 result = 1;
+                break;
             }
         }
         else if (action == PROTOCOL) {
-            reachableStates[next] = applyProtocols(reachableStates[i]);
+            current = applyProtocols(current);
+            lastShuffle.size = 0;
+            turnedPositions = 0;
 
             // only for not Final Runtime
-            if (isFinalState(reachableStates[next])) {
-                assume(next == L);
+            if (isFinalState(current)) {
+                assume(SYMMETRY_BREAKING || next == L);
                 result = 1;
+                break;
             }
         }
         else {
@@ -1246,7 +1449,8 @@ int main() {
 
     unsigned int arrSeqIdx[NUMBER_START_SEQS];
     for (unsigned int i = 0; i < NUMBER_START_SEQS; i++) {
-        arrSeqIdx[i] = getSequenceIndexFromArray(start[i], startState);
+        assume (isSequenceOfDeck(start[i]));
+        arrSeqIdx[i] = getSequenceIndexFromArray(start[i]);
     }
 
 
@@ -15,7 +15,7 @@ void __CPROVER_assert(int x, char y[]);
 /**
 * MODULES:
 * The maximum number of possible result states a protocol can have.
-* This is defined for all possibly used protocols because protocolStates needs to have a fixed size
+* This is defined for all possibly used protocols because applyProtocols checks every end state
 * it is currently defined as 2, because the protocol with the most endstates has 2 endstates
 */
 #ifndef MAX_PROTOCOL_ENDSTATES
@@ -174,113 +174,94 @@ unsigned int protocolTable[5][2][4][6] = { { { { 1,2,1,2,1,2 }, { 1,2,2,1,1,2 },
 
 
 
-/**
-* MODULES:
-* Analog to turn states, this struct is used to retun arrays of states after a protocol operation.
-* There is one state for each possible end state (resut state) of the protocol
-* In each usage of a protocol, for each sequence the resulting sequences in each end state are calculated and stored in states.
-* isUsed[i] contains if the corresponding state[i] holds a end state or isn't used
-*
-*/
-struct protocolStates {
-    struct state states[2];
-    unsigned int isUsed[MAX_PROTOCOL_ENDSTATES];
-};
-
-
 /**
 * MODULES:
 * finds the index of a given sequence (as an array) within a state.
+* All states are sorted lexicographically, hence the index is the rank of the sequence.
 */
 unsigned  int findIndex(struct sequence seq) {
-
-    unsigned int index = nondet_uint();
-
-    assume(index < NUMBER_POSSIBLE_SEQUENCES);
+    struct narray compare;
     for (int j = 0; j < N; j++) {
-        assume(seq.val[j] == emptyState.seq[index].val[j]);
+        compare.arr[j] = seq.val[j];
     }
-    return index;
+    assume(isSequenceOfDeck(compare));
+    return getSequenceIndexFromArray(compare);
 }
 /**
 * MODULES:
-* searches for the endSequence in result.states[resultIdx]
-* if found, copy the probabilities/possibilities from seq to result.states[resultIdx] and return new result
+* searches for the endSequence in result
+* if found, copy the probabilities/possibilities from seq to result and return new result
 */
-struct protocolStates copyResults(struct sequence seq, struct protocolStates result, unsigned int resultIdx) {
+struct state copyResults(struct sequence seq, struct state result) {
     //find index of sequence within state that matches endSequence
     unsigned int index = findIndex(seq);
 
-    // copy the probabilities/possibilities from seq to result.states[resultIdx] (! add the values -> cr shuffle)
+    // copy the probabilities/possibilities from seq to result (! add the values -> cr shuffle)
     for (unsigned int j = 0; j < NUMBER_PROBABILITIES; j++) {
         struct fraction prob = seq.probs.frac[j];
-        // Copy numerator.
-        result.states[resultIdx].seq[index].probs.frac[j].num += prob.num;
-
-        if (!WEAK_SECURITY) { // Probabilistic security
+        if (WEAK_SECURITY) {
+            // Possibilities are flags, which are single bits with COMPACT_BITS.
+            result.seq[index].probs.frac[j].num |= prob.num;
+        } else { // Probabilistic security
+            // Copy numerator.
+            result.seq[index].probs.frac[j].num += prob.num;
             // Copy denominator.
-            result.states[resultIdx].seq[index].probs.frac[j].den += prob.den;
+            result.seq[index].probs.frac[j].den += prob.den;
         }
     }
     return result;
 }
-struct protocolStates doProtocols(unsigned int protocolChosen, struct state s, unsigned int com1A, unsigned int com1B, unsigned int com2A, unsigned int com2B, unsigned int help1, unsigned int help2) {
-    struct protocolStates result;
-    // Initialise N empty states.
-    for (unsigned int i = 0; i < MAX_PROTOCOL_ENDSTATES; i++) {
-        result.states[i] = emptyState;
-        result.isUsed[i] = 0;
-    }
-    for (unsigned int i = 0; i < MAX_PROTOCOL_ENDSTATES; i++) {
-        for (unsigned int j = 0; j < NUMBER_POSSIBLE_SEQUENCES; j++) {
-            struct sequence seq = s.seq[j];
-            if (isStillPossible(seq.probs)) {
-                unsigned int idx = 0;
-                if (isZero(seq.val[com1A], seq.val[com1B])) {
-                    if (isZero(seq.val[com2A], seq.val[com2B])) {
-                        // 0101  
-                        idx = 0;
-                    }
-                    else if (isOne(seq.val[com2A], seq.val[com2B])) {
-                        // 0110
-                        idx = 1;
-                    }
+/**
+* MODULES:
+* Analog to the branches of a turn, calculates the end state (result state) endState of the protocol:
+* for each sequence, the resulting sequence in this end state is calculated and stored.
+* Only this end state is built, such that a protocol run stores one state per step.
+*/
+struct state doProtocol(unsigned int protocolChosen, struct state s, unsigned int com1A, unsigned int com1B, unsigned int com2A, unsigned int com2B, unsigned int help1, unsigned int help2, unsigned int endState) {
+    struct state result = emptyState;
+    for (unsigned int j = 0; j < NUMBER_POSSIBLE_SEQUENCES; j++) {
+        struct sequence seq = s.seq[j];
+        if (isStillPossible(seq.probs)) {
+            unsigned int idx = 0;
+            if (isZero(seq.val[com1A], seq.val[com1B])) {
+                if (isZero(seq.val[com2A], seq.val[com2B])) {
+                    // 0101  
+                    idx = 0;
                 }
-                else if (isOne(seq.val[com1A], seq.val[com1B])) {
-                    if (isZero(seq.val[com2A], seq.val[com2B])) {
-                        // 1001
-                        idx = 2;
-                    }
-                    else if (isOne(seq.val[com2A], seq.val[com2B])) {
-                        // 1010
-                        idx = 3;
-                    }
+                else if (isOne(seq.val[com2A], seq.val[com2B])) {
+                    // 0110
+                    idx = 1;
                 }
+            }
+            else if (isOne(seq.val[com1A], seq.val[com1B])) {
+                if (isZero(seq.val[com2A], seq.val[com2B])) {
+                    // 1001
+                    idx = 2;
+                }
+                else if (isOne(seq.val[com2A], seq.val[com2B])) {
+                    // 1010
+                    idx = 3;
+                }
+            }
 
 
-                seq.val[com1A] = protocolTable[protocolChosen][i][idx][0];
-                seq.val[com1B] = protocolTable[protocolChosen][i][idx][1];
-                seq.val[com2A] = protocolTable[protocolChosen][i][idx][2];
-                seq.val[com2B] = protocolTable[protocolChosen][i][idx][3];
+            seq.val[com1A] = protocolTable[protocolChosen][endState][idx][0];
+            seq.val[com1B] = protocolTable[protocolChosen][endState][idx][1];
+            seq.val[com2A] = protocolTable[protocolChosen][endState][idx][2];
+            seq.val[com2B] = protocolTable[protocolChosen][endState][idx][3];
 
-                // if we have one (or more) helper card
-                if (protocolChosen == FR_AND || protocolChosen == FR_COPY
-                    || protocolChosen == LV_AND) {
-                    seq.val[help1] = protocolTable[protocolChosen][i][idx][4];
-                    // if we have two helper cards
-                    if (protocolChosen == FR_AND || protocolChosen == FR_COPY) {
-                        seq.val[help2] = protocolTable[protocolChosen][i][idx][5];
-                    }
+            // if we have one (or more) helper card
+            if (protocolChosen == FR_AND || protocolChosen == FR_COPY
+                || protocolChosen == LV_AND) {
+                seq.val[help1] = protocolTable[protocolChosen][endState][idx][4];
+                // if we have two helper cards
+                if (protocolChosen == FR_AND || protocolChosen == FR_COPY) {
+                    seq.val[help2] = protocolTable[protocolChosen][endState][idx][5];
                 }
-                result = copyResults(seq, result, i);
-                result.isUsed[i] = 1;
             }
+            result = copyResults(seq, result);
         }
     }
-
-    for (unsigned int l = 0; l < MAX_PROTOCOL_ENDSTATES; l++) {
-        assume(isBottomFree(result.states[l]));
-    }
     return result;
 }
 struct state applyProtocols(struct state s) {
@@ -302,23 +283,17 @@ struct state applyProtocols(struct state s) {
     if (USE_FR_COPY == 0) {
         assume(protocolChosen != FR_COPY);
     }
-    // create resulting states
-    struct protocolStates resultingStates;
-    for (unsigned int i = 0; i < MAX_PROTOCOL_ENDSTATES; i++) {
-        resultingStates.states[i] = emptyState;
-        resultingStates.isUsed[i] = 0;
-    }
     // pick 4 cards that represent the two commitments
-    unsigned int com1A = nondet_uint();
-    unsigned int com1B = nondet_uint();
-    unsigned int com2A = nondet_uint();
-    unsigned int com2B = nondet_uint();
+    positionValue com1A = nondet_position();
+    positionValue com1B = nondet_position();
+    positionValue com2A = nondet_position();
+    positionValue com2B = nondet_position();
     assume(com1A < N&& com1B < N&& com2A < N&& com2B < N);
     assume(com1A != com1B && com1A != com2A && com1A != com2B);
     assume(com1B != com2A && com1B != com2B);
     assume(com2A != com2B);
-    unsigned int help1 = 0;
-    unsigned int help2 = 0;
+    positionValue help1 = 0;
+    positionValue help2 = 0;
     for (unsigned int i = 0; i < NUMBER_POSSIBLE_SEQUENCES; i++) {
         // if the probability/possibility of this state is not 0 
         if (isStillPossible(s.seq[i].probs)) {
@@ -339,7 +314,7 @@ struct state applyProtocols(struct state s) {
     }
     //protocols with five cards
     if (protocolChosen == LV_AND) {
-        help1 = nondet_uint();
+        help1 = nondet_position();
         assume(help1 < N);
         assume(help1 != com1A && help1 != com1B && help1 != com2A && help1 != com2B);
         for (unsigned int i = 0; i < NUMBER_POSSIBLE_SEQUENCES; i++) {
@@ -354,8 +329,8 @@ struct state applyProtocols(struct state s) {
         }
     }
     if (protocolChosen == FR_AND || protocolChosen == FR_COPY) {
-        help1 = nondet_uint();
-        help2 = nondet_uint();
+        help1 = nondet_position();
+        help2 = nondet_position();
         assume(help1 < N&& help2 < N);
         assume(help1 != com1A && help1 != com1B && help1 != com2A && help1 != com2B);
         assume(help2 != com1A && help2 != com1B && help2 != com2A && help2 != com2B && help2 != help1);
@@ -367,11 +342,18 @@ struct state applyProtocols(struct state s) {
             }
         }
     }
-    resultingStates = doProtocols(protocolChosen, s, com1A, com1B, com2A, com2B, help1, help2);
     //as with TURN, choose one output nondeterministically to look at further
     unsigned int stateIdx = nondet_uint();
     assume(stateIdx < MAX_PROTOCOL_ENDSTATES);
-    assume(resultingStates.isUsed[stateIdx]);
-    return resultingStates.states[stateIdx];
+    // every end state must be bottom free, but only the chosen one is kept
+    struct state result = emptyState;
+    for (unsigned int l = 0; l < MAX_PROTOCOL_ENDSTATES; l++) {
+        struct state endState = doProtocol(protocolChosen, s, com1A, com1B, com2A, com2B, help1, help2, l);
+        assume(isBottomFree(endState));
+        if (l == stateIdx) {
+            result = endState;
+        }
+    }
+    return result;
 }
 
@@ -0,0 +1,2354 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * Native explicit-state counterpart of performActions() in findTwoCardProtocol.c.
+ * Instead of handing the nondeterministic model to CBMC, all action sequences of length
+ * up to L are enumerated directly on concrete states. The configuration knobs are the
+ * same preprocessor constants as in the symbolic models and are passed via '-D MODE=PARAMETER'.
+ */
+
+/**
+ * Size of input sequence (number of cards including both commitments plus additional cards).
+ */
+#ifndef N
+#define N 4
+#endif
+
+/**
+ * Amount of distinguishable card symbols.
+ * We support two-color decks (2) and standard decks where all cards are distinct (N).
+ */
+#ifndef NUM_SYM
+#define NUM_SYM 2
+#endif
+
+/**
+ * Number of all cards used for commitments
+ */
+#ifndef COMMIT
+#define COMMIT 4
+#endif
+
+/**
+ * Protocol length.
+ */
+#ifndef L
+#define L 5
+#endif
+
+/**
+ * Amount of different action types allowed in protocol, excluding result action.
+ */
+#ifndef A
+#define A 2
+#endif
+
+/**
+ * Number assigned to turn action.
+ */
+#ifndef TURN
+#define TURN 0
+#endif
+
+/**
+ * Number assigned to shuffle action.
+ */
+#ifndef SHUFFLE
+#define SHUFFLE 1
+#endif
+
+/**
+ * Regarding possibilities for a sequence, we (only) consider
+ * - 0: probabilistic security
+ *      (exact possibilities for a sequence)
+ * - 1: input possibilistic security (yes or no)
+ *      (whether the sequence can belong to the specific input)
+ * - 2: output possibilistic security (yes or no)
+ *      (to which output the sequence can belong)
+ */
+#ifndef WEAK_SECURITY
+#define WEAK_SECURITY 2
+#endif
+
+/**
+ * We always had four input possibilities,
+ * this is changed if we only consider output possibilistic security.
+ */
+#if WEAK_SECURITY == 2
+    #define NUMBER_PROBABILITIES 2
+#else
+    #define NUMBER_PROBABILITIES 4
+#endif
+
+/**
+ * For two players inserting yes or no to a protocol,
+ * there are four different possibilities how the protocol could start.
+ */
+#ifndef NUMBER_START_SEQS
+#define NUMBER_START_SEQS 4
+#endif
+
+/**
+ * 1 is finite runtime, 0 is restart-free Las-Vegas.
+ */
+#ifndef FINITE_RUNTIME
+#define FINITE_RUNTIME 0
+#endif
+
+/**
+ * If set to 1, only closed protocols with closed shuffles will be searched.
+ */
+#ifndef CLOSED_PROTOCOL
+#define CLOSED_PROTOCOL 0
+#endif
+
+/**
+ * If set to 1, only protocols with random cuts will be searched.
+ */
+#ifndef FORCE_RANDOM_CUTS
+#define FORCE_RANDOM_CUTS 0
+#endif
+
+/**
+ * Factorials as integer constant expressions, such that the table sizes below
+ * do not have to be computed by a script.
+ */
+#define FACTORIAL(n) ((n) <= 1 ? 1 : (n) == 2 ? 2 : (n) == 3 ? 6 : (n) == 4 ? 24 \
+                      : (n) == 5 ? 120 : (n) == 6 ? 720 : (n) == 7 ? 5040 \
+                      : (n) == 8 ? 40320 : (n) == 9 ? 362880 : 3628800)
+
+#if N > 10
+#error "The native search supports at most ten cards."
+#endif
+
+#if NUM_SYM != 2 && NUM_SYM != N
+#error "The native search supports two-color decks (NUM_SYM=2) and standard decks (NUM_SYM=N)."
+#endif
+
+#if L > 255
+#error "The transposition table stores at most 255 remaining actions."
+#endif
+
+/**
+ * Maximum number of permutations for the given number of cards (N!).
+ */
+#ifndef NUMBER_POSSIBLE_PERMUTATIONS
+#define NUMBER_POSSIBLE_PERMUTATIONS FACTORIAL(N)
+#endif
+
+/**
+ * Number of sequences of the deck. For two-color decks, the first symbol occurs N/2 times
+ * and the second symbol takes the remaining cards (as computed by runTwoCard.sh).
+ */
+#ifndef NUMBER_POSSIBLE_SEQUENCES
+#if NUM_SYM == N
+#define NUMBER_POSSIBLE_SEQUENCES NUMBER_POSSIBLE_PERMUTATIONS
+#else
+#define NUMBER_POSSIBLE_SEQUENCES (FACTORIAL(N) / (FACTORIAL(N / 2) * FACTORIAL(N - N / 2)))
+#endif
+#endif
+
+/**
+ * This variable is used to limit the permutation set in any shuffle.
+ */
+#ifndef MAX_PERM_SET_SIZE
+#define MAX_PERM_SET_SIZE NUMBER_POSSIBLE_PERMUTATIONS
+#endif
+
+/**
+ * After a turn, the protocol tree splits up in one subtree for each possible observation.
+ * As in the symbolic models, we exclude the "trivial turn" where the turned card is already known.
+ */
+#ifndef MIN_TURN_OBSERVATIONS
+#define MIN_TURN_OBSERVATIONS 2
+#endif
+
+/**
+ * See description of MIN_TURN_OBSERVATIONS above.
+ */
+#ifndef MAX_TURN_OBSERVATIONS
+#define MAX_TURN_OBSERVATIONS NUM_SYM
+#endif
+
+/**
+ * Upper bound for the number of entries of the action table, see actionTable below.
+ */
+#ifndef MAX_ACTION_TABLE_ENTRIES
+#define MAX_ACTION_TABLE_ENTRIES (1u << 25)
+#endif
+
+/**
+ * Upper bound for the number of entries of the Cayley table, see cayleyTable below.
+ * The default covers up to seven cards.
+ */
+#ifndef MAX_CAYLEY_TABLE_ENTRIES
+#define MAX_CAYLEY_TABLE_ENTRIES (1u << 25)
+#endif
+
+/**
+ * Upper bound for the number of entries of all orbit tables together, see struct shuffle.
+ */
+#ifndef MAX_ORBIT_TABLE_ENTRIES
+#define MAX_ORBIT_TABLE_ENTRIES (1u << 25)
+#endif
+
+/**
+ * Memory budget of the transposition table in megabytes, 0 disables it.
+ */
+#ifndef TRANSPOSITION_TABLE_MEGABYTES
+#define TRANSPOSITION_TABLE_MEGABYTES 1024
+#endif
+
+/**
+ * Number of consecutive slots of the transposition table in which a state may be stored.
+ */
+#ifndef TRANSPOSITION_PROBES
+#define TRANSPOSITION_PROBES 4
+#endif
+
+/**
+ * If set, the protocol lengths 1..L are searched one after another, such that the shortest
+ * protocol is found first. The transposition table is kept between the iterations.
+ */
+#ifndef ITERATIVE_DEEPENING
+#define ITERATIVE_DEEPENING 0
+#endif
+
+/**
+ * Number of worker threads, 0 uses all online processors.
+ */
+#ifndef THREADS
+#define THREADS 0
+#endif
+
+/**
+ * A thread hands subtrees of its search to its task deque, from which idle threads steal,
+ * as long as fewer than TASKS_PER_THREAD tasks per thread are pending.
+ */
+#ifndef TASKS_PER_THREAD
+#define TASKS_PER_THREAD 8
+#endif
+
+/**
+ * If set, states which only differ by a relabeling of the card positions share their entry
+ * of the transposition table, and so do states of two-color decks with equally many cards
+ * per color which only differ by swapping the colors. This is exact as long as the searched
+ * shuffles are closed under conjugation, which does not hold for FORCE_RANDOM_CUTS.
+ * Every lookup relabels the state with all NUMBER_POSSIBLE_PERMUTATIONS permutations.
+ */
+#ifndef SYMMETRY_REDUCTION
+#define SYMMETRY_REDUCTION (N <= 6 && !FORCE_RANDOM_CUTS)
+#endif
+
+/**
+ * Seconds between two checkpoints of the search (option -c).
+ */
+#ifndef CHECKPOINT_SECONDS
+#define CHECKPOINT_SECONDS 600
+#endif
+
+/**
+ * Subgroup catalogue written by ../shared/generateSubgroups.c. If it cannot be read,
+ * the subgroups are enumerated when the search starts.
+ */
+#ifndef SUBGROUP_CATALOGUE
+#define SUBGROUP_CATALOGUE "../shared/generated/subgroups_N%u.bin"
+#endif
+
+#if WEAK_SECURITY
+/**
+ * Number of 64-bit words of a bitset over all sequences.
+ */
+#define SEQUENCE_WORDS ((NUMBER_POSSIBLE_SEQUENCES + 63) / 64)
+
+/**
+ * One state of the KWH tree. In the possibilistic settings, only whether a sequence belongs
+ * to an input (or output) possibility matters, so we store one bitset over the sequence
+ * indices per possibility. Bottom checks, shuffles and turns then work on whole words.
+ */
+struct state {
+    uint64_t mask[NUMBER_PROBABILITIES][SEQUENCE_WORDS];
+};
+#else
+/**
+ * One state of the KWH tree. For every sequence and every input possibility,
+ * we store the numerator of its probability. All numerators share the denominator den,
+ * such that no fractions have to be aligned.
+ */
+struct state {
+    unsigned long long num[NUMBER_POSSIBLE_SEQUENCES][NUMBER_PROBABILITIES];
+    unsigned long long den;
+};
+#endif
+
+/**
+ * A shuffle operation given by the (lexicographically sorted) indices of its permutations.
+ * For possibilistic security, closed shuffles additionally store the partition of all
+ * sequences into orbits: orbitOf maps each sequence to its orbit, and orbitMasks holds
+ * SEQUENCE_WORDS words per orbit. Both are NULL if the orbits were not computed.
+ */
+struct shuffle {
+    unsigned int size;
+    unsigned int *perms;
+    unsigned int numberOrbits;
+    unsigned int *orbitOf;
+    uint64_t *orbitMasks;
+};
+
+/**
+ * One action of a found protocol together with the state it leads to.
+ */
+struct protocolStep {
+    unsigned int action;
+    unsigned int turnPosition;
+    unsigned int observation;
+    unsigned int permSetSize;
+    unsigned int *perms;
+    struct state state;
+};
+
+/**
+ * All sequences of the deck, as seen from left to right, sorted alphabetically.
+ * Cards carry the symbols 1..NUM_SYM.
+ */
+unsigned int sequences[NUMBER_POSSIBLE_SEQUENCES][N];
+
+/**
+ * All permutations, sorted alphabetically. Permutation p moves the card at
+ * position k to position permutations[p][k], as in doShuffle() of the symbolic models.
+ */
+unsigned int permutations[NUMBER_POSSIBLE_PERMUTATIONS][N];
+
+/**
+ * Index of the sequence resulting from applying permutation p to sequence s, stored at
+ * actionTable[p * NUMBER_POSSIBLE_SEQUENCES + s]. It is only allocated if it has at most
+ * MAX_ACTION_TABLE_ENTRIES entries, otherwise the permutations are applied card by card.
+ */
+#if NUMBER_POSSIBLE_SEQUENCES <= 65536
+typedef uint16_t actionIndex;
+#else
+typedef uint32_t actionIndex;
+#endif
+actionIndex *actionTable;
+
+/**
+ * Index of combinePermutations(a, b), stored at cayleyTable[a * NUMBER_POSSIBLE_PERMUTATIONS + b].
+ * It is only allocated if it has at most MAX_CAYLEY_TABLE_ENTRIES entries.
+ */
+uint16_t *cayleyTable;
+
+/**
+ * Number of 64-bit words of a membership bitset over all permutations.
+ */
+#define PERMUTATION_WORDS ((NUMBER_POSSIBLE_PERMUTATIONS + 63) / 64)
+
+#if WEAK_SECURITY
+/**
+ * observationMasks[p][o] contains all sequences which show symbol o + 1 at position p.
+ */
+uint64_t observationMasks[N][NUM_SYM][SEQUENCE_WORDS];
+#endif
+
+/**
+ * Number of cards per symbol in the deck.
+ */
+unsigned int symbolCount[NUM_SYM];
+
+/**
+ * Index of the sequence with swapped colors, only used if SWAP_COLORS is set.
+ */
+#define SWAP_COLORS (NUM_SYM == 2 && N % 2 == 0)
+unsigned int swappedSequences[NUMBER_POSSIBLE_SEQUENCES];
+
+/**
+ * All shuffles that are searched for closed protocols or random cuts.
+ */
+struct shuffle *shuffles;
+unsigned int numberShuffles;
+
+/**
+ * Number of entries of all orbit tables, bounded by MAX_ORBIT_TABLE_ENTRIES.
+ */
+unsigned long long orbitTableEntries;
+
+/**
+ * The protocol which is currently explored by this thread, one entry per action.
+ */
+_Thread_local struct protocolStep *protocol;
+
+/**
+ * Length bound of the current search, L unless ITERATIVE_DEEPENING is set.
+ */
+unsigned int maxLength = L;
+
+/**
+ * Lock-free transposition table with open addressing. A slot holds the fingerprint of a state
+ * (the upper 56 bits of its check hash) and, in the lowest byte, the number of remaining
+ * actions for which no protocol exists from that state. Empty slots are 0. A state is stored
+ * in one of TRANSPOSITION_PROBES slots after the one selected by its key hash.
+ */
+#define TRANSPOSITION_REMAINING 0xFFull
+_Atomic uint64_t *transpositionTable;
+size_t transpositionSlots;
+
+/**
+ * The start state of the protocol which is currently explored by this thread.
+ */
+_Thread_local struct state *startState;
+
+/**
+ * Partial results while enumerating arbitrary permutation sets, one row per protocol step.
+ */
+_Thread_local struct state *partialShuffleStates;
+
+_Thread_local unsigned long long exploredStates;
+atomic_ullong totalExploredStates;
+
+/**
+ * A subtree of the search: the protocol prefix of depth actions and its start state.
+ */
+struct task {
+    unsigned int depth;
+    struct state startState;
+    struct protocolStep *steps;
+};
+
+/**
+ * Tasks of one thread. The owner pushes and pops at the end, other threads steal
+ * the oldest (and usually largest) task at the beginning.
+ */
+struct taskDeque {
+    pthread_mutex_t lock;
+    struct task **tasks;
+    unsigned int begin;
+    unsigned int end;
+    unsigned int capacity;
+};
+struct taskDeque *taskDeques;
+unsigned int numberThreads;
+
+/**
+ * Index of the deque of this thread, and the number of tasks it has spawned.
+ */
+_Thread_local unsigned int workerIndex;
+_Thread_local unsigned long long spawnedTasks;
+
+/**
+ * Number of tasks which are queued or running, and whether a protocol was found.
+ */
+atomic_uint pendingTasks;
+atomic_uint protocolFound;
+
+/**
+ * File for the record of a found protocol (option -r), NULL if none is written, and the
+ * time the search started.
+ */
+const char *recordPath;
+struct timespec searchBegin;
+
+/**
+ * File of the checkpoints (option -c), NULL if none are written. A checkpoint is taken by
+ * pausing all workers once their running tasks are handed to the deques, such that the
+ * deques hold the whole frontier of the search. The workers which are paused are counted
+ * in pausedWorkers, and checkpointGeneration advances whenever they are released.
+ */
+const char *checkpointPath;
+atomic_uint checkpointRequested;
+pthread_mutex_t checkpointLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t checkpointDone = PTHREAD_COND_INITIALIZER;
+unsigned int runningWorkers;
+unsigned int pausedWorkers;
+unsigned long long checkpointGeneration;
+struct timespec lastCheckpoint;
+
+/**
+ * Set by SIGTERM or SIGINT if checkpoints are written: the search stops after the next one.
+ */
+volatile sig_atomic_t stopRequested;
+
+/**
+ * Seconds the search ran before it was resumed from a checkpoint.
+ */
+double resumedSeconds;
+
+#include "../shared/sequenceRanking.c"
+#include "../shared/protocolRecord.c"
+
+/**
+ * Rearranges arr into the lexicographically next arrangement of its values.
+ * Returns 0 iff arr already was the last arrangement.
+ */
+unsigned int nextArrangement(unsigned int arr[], unsigned int length) {
+    if (length < 2) {
+        return 0;
+    }
+    unsigned int i = length - 1;
+    while (i > 0 && arr[i - 1] >= arr[i]) {
+        i--;
+    }
+    if (i == 0) {
+        return 0;
+    }
+    unsigned int j = length - 1;
+    while (arr[j] <= arr[i - 1]) {
+        j--;
+    }
+    unsigned int tmp = arr[i - 1];
+    arr[i - 1] = arr[j];
+    arr[j] = tmp;
+    for (unsigned int k = i, m = length - 1; k < m; k++, m--) {
+        tmp = arr[k];
+        arr[k] = arr[m];
+        arr[m] = tmp;
+    }
+    return 1;
+}
+
+/**
+ * Given an array containing a sequence, we return the index of the given sequence.
+ * The sequences are sorted, such that the index is the rank of the sequence.
+ */
+unsigned int getSequenceIndexFromArray(const unsigned int compare[N]) {
+    return getSequenceRank(compare);
+}
+
+/**
+ * Given an array containing a permutation, we return its index.
+ */
+unsigned int getPermutationIndexFromArray(const unsigned int compare[N]) {
+    return getPermutationRank(compare);
+}
+
+/**
+ * Fills the sequence and permutation tables in lexicographic order.
+ */
+void initTables() {
+    unsigned int arr[N];
+    unsigned int pos = 0;
+    for (unsigned int i = 0; i < NUM_SYM; i++) {
+        symbolCount[i] = (i < NUM_SYM - 1) ? N / NUM_SYM : N - (NUM_SYM - 1) * (N / NUM_SYM);
+        for (unsigned int j = 0; j < symbolCount[i]; j++) {
+            arr[pos++] = i + 1;
+        }
+    }
+    unsigned int count = 0;
+    do {
+        if (count == NUMBER_POSSIBLE_SEQUENCES) {
+            fprintf(stderr, "NUMBER_POSSIBLE_SEQUENCES is too small for this deck.\n");
+            exit(1);
+        }
+        memcpy(sequences[count++], arr, sizeof(arr));
+    } while (nextArrangement(arr, N));
+    if (count != NUMBER_POSSIBLE_SEQUENCES) {
+        fprintf(stderr, "NUMBER_POSSIBLE_SEQUENCES does not match the deck.\n");
+        exit(1);
+    }
+
+#if WEAK_SECURITY
+    for (unsigned int i = 0; i < NUMBER_POSSIBLE_SEQUENCES; i++) {
+        for (unsigned int p = 0; p < N; p++) {
+            observationMasks[p][sequences[i][p] - 1][i / 64] |= (uint64_t)1 << (i % 64);
+        }
+    }
+#endif
+
+    for (unsigned int i = 0; SWAP_COLORS && i < NUMBER_POSSIBLE_SEQUENCES; i++) {
+        for (unsigned int k = 0; k < N; k++) {
+            arr[k] = 3 - sequences[i][k];
+        }
+        swappedSequences[i] = getSequenceIndexFromArray(arr);
+    }
+
+    for (unsigned int i = 0; i < N; i++) {
+        arr[i] = i;
+    }
+    count = 0;
+    do {
+        memcpy(permutations[count++], arr, sizeof(arr));
+    } while (nextArrangement(arr, N));
+}
+
+/**
+ * Index of the sequence that results from applying permutation perm to sequence seq.
+ */
+unsigned int applyPermutation(unsigned int perm, unsigned int seq) {
+    if (actionTable) {
+        return actionTable[(size_t)perm * NUMBER_POSSIBLE_SEQUENCES + seq];
+    }
+    unsigned int resultingSeq[N];
+    for (unsigned int k = 0; k < N; k++) {
+        resultingSeq[permutations[perm][k]] = sequences[seq][k];
+    }
+    return getSequenceIndexFromArray(resultingSeq);
+}
+
+/**
+ * Precomputes applyPermutation() for all pairs of permutations and sequences, such that
+ * every shuffle only needs one lookup per pair.
+ */
+void initActionTable() {
+    if ((unsigned long long)NUMBER_POSSIBLE_PERMUTATIONS * NUMBER_POSSIBLE_SEQUENCES
+        > MAX_ACTION_TABLE_ENTRIES) {
+        return;
+    }
+    actionIndex *table = malloc((size_t)NUMBER_POSSIBLE_PERMUTATIONS
+                                * NUMBER_POSSIBLE_SEQUENCES * sizeof(actionIndex));
+    if (!table) {
+        return;
+    }
+    for (unsigned int p = 0; p < NUMBER_POSSIBLE_PERMUTATIONS; p++) {
+        for (unsigned int i = 0; i < NUMBER_POSSIBLE_SEQUENCES; i++) {
+            table[(size_t)p * NUMBER_POSSIBLE_SEQUENCES + i] = applyPermutation(p, i);
+        }
+    }
+    actionTable = table;
+}
+
+/**
+ * Index of the permutation that first applies firstPermutation and subsequently secondPermutation.
+ */
+unsigned int combinePermutations(unsigned int firstPermutation, unsigned int secondPermutation) {
+    if (cayleyTable) {
+        return cayleyTable[(size_t)firstPermutation * NUMBER_POSSIBLE_PERMUTATIONS
+                           + secondPermutation];
+    }
+    unsigned int result[N];
+    for (unsigned int k = 0; k < N; k++) {
+        result[k] = permutations[secondPermutation][permutations[firstPermutation][k]];
+    }
+    return getPermutationIndexFromArray(result);
+}
+
+/**
+ * Precomputes combinePermutations() for all pairs of permutations (the multiplication table of S_N).
+ */
+void initCayleyTable() {
+    if ((unsigned long long)NUMBER_POSSIBLE_PERMUTATIONS * NUMBER_POSSIBLE_PERMUTATIONS
+        > MAX_CAYLEY_TABLE_ENTRIES || NUMBER_POSSIBLE_PERMUTATIONS > 65536) {
+        return;
+    }
+    uint16_t *table = malloc((size_t)NUMBER_POSSIBLE_PERMUTATIONS
+                             * NUMBER_POSSIBLE_PERMUTATIONS * sizeof(uint16_t));
+    if (!table) {
+        return;
+    }
+    for (unsigned int a = 0; a < NUMBER_POSSIBLE_PERMUTATIONS; a++) {
+        for (unsigned int b = 0; b < NUMBER_POSSIBLE_PERMUTATIONS; b++) {
+            table[(size_t)a * NUMBER_POSSIBLE_PERMUTATIONS + b] = combinePermutations(a, b);
+        }
+    }
+    cayleyTable = table;
+}
+
+/**
+ * Membership test and insertion for bitsets over all permutations.
+ */
+unsigned int isMember(const uint64_t *members, unsigned int perm) {
+    return (members[perm / 64] >> (perm % 64)) & 1;
+}
+
+void addMember(uint64_t *members, unsigned int perm) {
+    members[perm / 64] |= (uint64_t)1 << (perm % 64);
+}
+
+#if WEAK_SECURITY
+/**
+ * Constructor for states. Only use this to create new states.
+ */
+void getEmptyState(struct state *s) {
+    memset(s->mask, 0, sizeof(s->mask));
+}
+
+/**
+ * Determines whether the sequence belongs to the given input (or output) possibility.
+ */
+unsigned int hasProbability(const struct state *s, unsigned int seq, unsigned int k) {
+    return (s->mask[k][seq / 64] >> (seq % 64)) & 1;
+}
+
+/**
+ * Assigns the sequence to the given input (or output) possibility.
+ */
+void setProbability(struct state *s, unsigned int seq, unsigned int k) {
+    s->mask[k][seq / 64] |= (uint64_t)1 << (seq % 64);
+}
+
+/**
+ * Word w of the bitset of all sequences which belong to at least one input sequence.
+ */
+uint64_t getPossibleWord(const struct state *s, unsigned int w) {
+    uint64_t word = 0;
+    for (unsigned int k = 0; k < NUMBER_PROBABILITIES; k++) {
+        word |= s->mask[k][w];
+    }
+    return word;
+}
+
+/**
+ * Word w of the bitset of all bottom sequences (belonging to more than one possible output).
+ */
+uint64_t getBottomWord(const struct state *s, unsigned int w) {
+    if (WEAK_SECURITY == 2) {
+        return s->mask[0][w] & s->mask[1][w];
+    }
+    return (s->mask[0][w] | s->mask[1][w] | s->mask[2][w]) & s->mask[NUMBER_PROBABILITIES - 1][w];
+}
+
+/**
+ * Determines whether the sequence belongs to at least one input sequence.
+ */
+unsigned int isStillPossible(const struct state *s, unsigned int seq) {
+    return (getPossibleWord(s, seq / 64) >> (seq % 64)) & 1;
+}
+
+/**
+ * Check if the sequence is a bottom sequence (belongs to more than one possible output).
+ */
+unsigned int isBottom(const struct state *s, unsigned int seq) {
+    return (getBottomWord(s, seq / 64) >> (seq % 64)) & 1;
+}
+
+/**
+ * Check a state for bottom sequences.
+ */
+unsigned int isBottomFree(const struct state *s) {
+    for (unsigned int w = 0; w < SEQUENCE_WORDS; w++) {
+        if (getBottomWord(s, w)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Checks whether every input (or output) possibility still belongs to some sequence.
+ * The symbolic models assume this for every state in isValid().
+ */
+unsigned int containsAllProbabilities(const struct state *s) {
+    for (unsigned int k = 0; k < NUMBER_PROBABILITIES; k++) {
+        uint64_t found = 0;
+        for (unsigned int w = 0; w < SEQUENCE_WORDS; w++) {
+            found |= s->mask[k][w];
+        }
+        if (!found) {
+            return 0;
+        }
+    }
+    return 1;
+}
+#else
+/**
+ * Constructor for states. Only use this to create new states.
+ */
+void getEmptyState(struct state *s) {
+    memset(s->num, 0, sizeof(s->num));
+    s->den = 1;
+}
+
+/**
+ * Determines whether the sequence belongs to the given input possibility.
+ */
+unsigned int hasProbability(const struct state *s, unsigned int seq, unsigned int k) {
+    return s->num[seq][k] != 0;
+}
+
+/**
+ * Assigns the sequence to the given input possibility (before any action).
+ */
+void setProbability(struct state *s, unsigned int seq, unsigned int k) {
+    s->num[seq][k] = 1;
+}
+
+/**
+ * Determines whether the sequence belongs to at least one input sequence.
+ */
+unsigned int isStillPossible(const struct state *s, unsigned int seq) {
+    unsigned int res = 0;
+    for (unsigned int i = 0; i < NUMBER_PROBABILITIES; i++) {
+        res |= (s->num[seq][i] != 0);
+    }
+    return res;
+}
+
+/**
+ * Check if the sequence is a bottom sequence (belongs to more than one possible output).
+ */
+unsigned int isBottom(const struct state *s, unsigned int seq) {
+    const unsigned long long *probs = s->num[seq];
+    if (WEAK_SECURITY == 2) {
+        return probs[0] && probs[1];
+    }
+    return (probs[0] || probs[1] || probs[2]) && probs[NUMBER_PROBABILITIES - 1];
+}
+
+/**
+ * Check a state for bottom sequences.
+ */
+unsigned int isBottomFree(const struct state *s) {
+    for (unsigned int i = 0; i < NUMBER_POSSIBLE_SEQUENCES; i++) {
+        if (isBottom(s, i)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Checks whether every input (or output) possibility still belongs to some sequence.
+ * The symbolic models assume this for every state in isValid().
+ */
+unsigned int containsAllProbabilities(const struct state *s) {
+    for (unsigned int k = 0; k < NUMBER_PROBABILITIES; k++) {
+        unsigned int found = 0;
+        for (unsigned int i = 0; !found && i < NUMBER_POSSIBLE_SEQUENCES; i++) {
+            found = (s->num[i][k] != 0);
+        }
+        if (!found) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+#endif
+
+/**
+ * Checks whether a state neither contains bottom sequences nor excludes inputs.
+ */
+unsigned int isValid(const struct state *s) {
+    return isBottomFree(s) && containsAllProbabilities(s);
+}
+
+/**
+ * Checks whether the state contains two columns that encode a valid result bit.
+ * If so, the two columns are stored in resA and resB.
+ */
+unsigned int isFinalState(const struct state *s, unsigned int *resA, unsigned int *resB) {
+    if (!isValid(s)) {
+        return 0;
+    }
+    for (unsigned int a = 0; a < N; a++) {
+        for (unsigned int b = 0; b < N; b++) {
+            if (a == b) {
+                continue;
+            }
+            unsigned int lowerCard = 0;
+            unsigned int higherCard = 0;
+            unsigned int res = 1;
+            for (unsigned int i = 0; res && i < NUMBER_POSSIBLE_SEQUENCES; i++) {
+                if (isStillPossible(s, i)) {
+                    unsigned int deciding = hasProbability(s, i, NUMBER_PROBABILITIES - 1);
+                    unsigned int first = sequences[i][a];
+                    unsigned int second = sequences[i][b];
+                    if (first == second) {
+                        res = 0;
+                    } else if (!higherCard) {
+                        // In a 1-sequence, the first card is higher, otherwise the second one.
+                        higherCard = deciding ? first : second;
+                        lowerCard = deciding ? second : first;
+                    } else {
+                        res = deciding ? (first == higherCard && second == lowerCard)
+                                       : (second == higherCard && first == lowerCard);
+                    }
+                }
+            }
+            if (res) {
+                *resA = a;
+                *resB = b;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+#if WEAK_SECURITY
+/**
+ * Adds the possibilities of sequence seq in s, permuted by perm, to the result.
+ */
+void addPermutedSequence(const struct state *s, unsigned int seq,
+                         unsigned int perm, struct state *res) {
+    unsigned int resultSeqIndex = applyPermutation(perm, seq);
+    for (unsigned int k = 0; k < NUMBER_PROBABILITIES; k++) {
+        if (hasProbability(s, seq, k)) {
+            setProbability(res, resultSeqIndex, k);
+        }
+    }
+}
+
+/**
+ * Possibilistic shuffles need no normalisation.
+ */
+void finishShuffle(const struct state *s, unsigned int permSetSize, struct state *res) {
+    (void)s;
+    (void)permSetSize;
+    (void)res;
+}
+
+/**
+ * Calculate the state after a shuffle operation starting from s with the given permutation set.
+ */
+void doShuffle(const struct state *s, const unsigned int *perms,
+               unsigned int permSetSize, struct state *res) {
+    getEmptyState(res);
+    for (unsigned int w = 0; w < SEQUENCE_WORDS; w++) {
+        for (uint64_t possible = getPossibleWord(s, w); possible; possible &= possible - 1) {
+            unsigned int i = 64 * w + __builtin_ctzll(possible);
+            for (unsigned int j = 0; j < permSetSize; j++) {
+                addPermutedSequence(s, i, perms[j], res);
+            }
+        }
+    }
+}
+
+/**
+ * Swaps the two colors of all sequences of s.
+ */
+void swapColors(const struct state *s, struct state *res) {
+    getEmptyState(res);
+    for (unsigned int w = 0; w < SEQUENCE_WORDS; w++) {
+        for (uint64_t possible = getPossibleWord(s, w); possible; possible &= possible - 1) {
+            unsigned int i = 64 * w + __builtin_ctzll(possible);
+            for (unsigned int k = 0; k < NUMBER_PROBABILITIES; k++) {
+                if (hasProbability(s, i, k)) {
+                    setProbability(res, swappedSequences[i], k);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Calculate the state after the closed shuffle sh starting from s. As the permutations
+ * form a group, every possibility of a sequence spreads over its whole orbit.
+ */
+void doClosedShuffle(const struct state *s, const struct shuffle *sh, struct state *res) {
+    if (!sh->orbitMasks) {
+        doShuffle(s, sh->perms, sh->size, res);
+        return;
+    }
+    getEmptyState(res);
+    for (unsigned int k = 0; k < NUMBER_PROBABILITIES; k++) {
+        uint64_t *result = res->mask[k];
+        for (unsigned int w = 0; w < SEQUENCE_WORDS; w++) {
+            // Each sequence lies in its own orbit, so every step removes at least one bit.
+            for (uint64_t open = s->mask[k][w]; open; open &= ~result[w]) {
+                unsigned int i = 64 * w + __builtin_ctzll(open);
+                const uint64_t *orbit = &sh->orbitMasks[(size_t)sh->orbitOf[i] * SEQUENCE_WORDS];
+                for (unsigned int v = 0; v < SEQUENCE_WORDS; v++) {
+                    result[v] |= orbit[v];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Copies all sequences of s with the symbol observation at turnPosition into res.
+ * Returns 1 iff the resulting branch is secure, i.e., every input (or output) possibility
+ * remains possible.
+ */
+unsigned int copyObservation(const struct state *s, unsigned int turnPosition,
+                             unsigned int observation, struct state *res) {
+    const uint64_t *observed = observationMasks[turnPosition][observation - 1];
+    unsigned int secure = 1;
+    for (unsigned int k = 0; k < NUMBER_PROBABILITIES; k++) {
+        uint64_t found = 0;
+        for (unsigned int w = 0; w < SEQUENCE_WORDS; w++) {
+            res->mask[k][w] = s->mask[k][w] & observed[w];
+            found |= res->mask[k][w];
+        }
+        secure &= (found != 0);
+    }
+    return secure;
+}
+
+/**
+ * Counts how many different symbols can be observed when turning the card at turnPosition.
+ */
+unsigned int countTurnObservations(const struct state *s, unsigned int turnPosition) {
+    unsigned int cntTurnObservations = 0;
+    for (unsigned int o = 0; o < NUM_SYM; o++) {
+        uint64_t found = 0;
+        for (unsigned int w = 0; !found && w < SEQUENCE_WORDS; w++) {
+            found = getPossibleWord(s, w) & observationMasks[turnPosition][o][w];
+        }
+        cntTurnObservations += (found != 0);
+    }
+    return cntTurnObservations;
+}
+
+/**
+ * Prints a state, one possible sequence per line.
+ */
+void printState(const struct state *s) {
+    for (unsigned int i = 0; i < NUMBER_POSSIBLE_SEQUENCES; i++) {
+        if (isStillPossible(s, i)) {
+            printf("      ");
+            for (unsigned int j = 0; j < N; j++) {
+                printf("%u", sequences[i][j]);
+            }
+            printf(" :");
+            for (unsigned int k = 0; k < NUMBER_PROBABILITIES; k++) {
+                printf(" %u", hasProbability(s, i, k));
+            }
+            printf("\n");
+        }
+    }
+}
+#else
+/**
+ * Greatest common divisor, used to keep the probabilities small.
+ */
+unsigned long long gcd(unsigned long long a, unsigned long long b) {
+    while (b) {
+        unsigned long long t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/**
+ * Reduces all numerators and the common denominator of a state.
+ */
+void reduceFractions(struct state *s) {
+    unsigned long long divisor = s->den;
+    for (unsigned int i = 0; divisor > 1 && i < NUMBER_POSSIBLE_SEQUENCES; i++) {
+        for (unsigned int k = 0; k < NUMBER_PROBABILITIES; k++) {
+            divisor = gcd(divisor, s->num[i][k]);
+        }
+    }
+    if (divisor > 1) {
+        for (unsigned int i = 0; i < NUMBER_POSSIBLE_SEQUENCES; i++) {
+            for (unsigned int k = 0; k < NUMBER_PROBABILITIES; k++) {
+                s->num[i][k] /= divisor;
+            }
+        }
+        s->den /= divisor;
+    }
+}
+
+/**
+ * Adds the possibilities of sequence seq in s, permuted by perm, to the (unnormalised) result.
+ */
+void addPermutedSequence(const struct state *s, unsigned int seq,
+                         unsigned int perm, struct state *res) {
+    unsigned int resultSeqIndex = applyPermutation(perm, seq);
+    for (unsigned int k = 0; k < NUMBER_PROBABILITIES; k++) {
+        res->num[resultSeqIndex][k] += s->num[seq][k];
+    }
+}
+
+/**
+ * Normalises the result res of shuffling s with permSetSize permutations.
+ * Shuffles are assumed to be uniformly distributed.
+ */
+void finishShuffle(const struct state *s, unsigned int permSetSize, struct state *res) {
+    res->den = s->den * permSetSize;
+    reduceFractions(res);
+}
+
+/**
+ * Calculate the state after a shuffle operation starting from s with the given permutation set.
+ */
+void doShuffle(const struct state *s, const unsigned int *perms,
+               unsigned int permSetSize, struct state *res) {
+    getEmptyState(res);
+    for (unsigned int i = 0; i < NUMBER_POSSIBLE_SEQUENCES; i++) {
+        if (isStillPossible(s, i)) {
+            for (unsigned int j = 0; j < permSetSize; j++) {
+                addPermutedSequence(s, i, perms[j], res);
+            }
+        }
+    }
+    finishShuffle(s, permSetSize, res);
+}
+
+/**
+ * Swaps the two colors of all sequences of s.
+ */
+void swapColors(const struct state *s, struct state *res) {
+    for (unsigned int i = 0; i < NUMBER_POSSIBLE_SEQUENCES; i++) {
+        memcpy(res->num[swappedSequences[i]], s->num[i], sizeof(s->num[i]));
+    }
+    res->den = s->den;
+}
+
+/**
+ * Calculate the state after the closed shuffle sh starting from s.
+ */
+void doClosedShuffle(const struct state *s, const struct shuffle *sh, struct state *res) {
+    doShuffle(s, sh->perms, sh->size, res);
+}
+
+/**
+ * Copies all sequences of s with the symbol observation at turnPosition into res.
+ * Returns 1 iff the resulting branch is secure, i.e., every input possibility
+ * remains possible and equally likely.
+ */
+unsigned int copyObservation(const struct state *s, unsigned int turnPosition,
+                             unsigned int observation, struct state *res) {
+    unsigned long long mass[NUMBER_PROBABILITIES] = { 0 };
+    getEmptyState(res);
+    for (unsigned int i = 0; i < NUMBER_POSSIBLE_SEQUENCES; i++) {
+        if (sequences[i][turnPosition] == observation) {
+            for (unsigned int k = 0; k < NUMBER_PROBABILITIES; k++) {
+                res->num[i][k] = s->num[i][k];
+                mass[k] += s->num[i][k];
+            }
+        }
+    }
+    for (unsigned int k = 0; k < NUMBER_PROBABILITIES; k++) {
+        if (!mass[k] || mass[k] != mass[0]) {
+            return 0;
+        }
+    }
+    // Conditioning on the observation: the probability of the branch becomes the denominator.
+    res->den = mass[0];
+    reduceFractions(res);
+    return 1;
+}
+
+/**
+ * Counts how many different symbols can be observed when turning the card at turnPosition.
+ */
+unsigned int countTurnObservations(const struct state *s, unsigned int turnPosition) {
+    unsigned int isUsed[NUM_SYM] = { 0 };
+    unsigned int cntTurnObservations = 0;
+    for (unsigned int i = 0; i < NUMBER_POSSIBLE_SEQUENCES; i++) {
+        if (isStillPossible(s, i)) {
+            unsigned int turnIdx = sequences[i][turnPosition] - 1;
+            cntTurnObservations += isUsed[turnIdx] ? 0 : 1;
+            isUsed[turnIdx] = 1;
+        }
+    }
+    return cntTurnObservations;
+}
+
+/**
+ * Prints a state, one possible sequence per line.
+ */
+void printState(const struct state *s) {
+    for (unsigned int i = 0; i < NUMBER_POSSIBLE_SEQUENCES; i++) {
+        if (isStillPossible(s, i)) {
+            printf("      ");
+            for (unsigned int j = 0; j < N; j++) {
+                printf("%u", sequences[i][j]);
+            }
+            printf(" :");
+            for (unsigned int k = 0; k < NUMBER_PROBABILITIES; k++) {
+                printf(" %llu/%llu", s->num[i][k], s->den);
+            }
+            printf("\n");
+        }
+    }
+}
+#endif
+
+unsigned int performActions(unsigned int depth);
+
+/**
+ * Adds a task to the end of the given deque.
+ */
+void pushTask(struct taskDeque *deque, struct task *t) {
+    atomic_fetch_add(&pendingTasks, 1);
+    pthread_mutex_lock(&deque->lock);
+    if (deque->end == deque->capacity) {
+        memmove(deque->tasks, deque->tasks + deque->begin,
+                (deque->end - deque->begin) * sizeof(struct task *));
+        deque->end -= deque->begin;
+        deque->begin = 0;
+        if (deque->end == deque->capacity) {
+            deque->capacity = deque->capacity ? 2 * deque->capacity : 64;
+            deque->tasks = realloc(deque->tasks, deque->capacity * sizeof(struct task *));
+        }
+    }
+    deque->tasks[deque->end++] = t;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+/**
+ * Removes a task from the end (own deque) or the beginning (stealing) of the deque.
+ * Returns NULL if the deque is empty.
+ */
+struct task *takeTask(struct taskDeque *deque, unsigned int steal) {
+    struct task *t = NULL;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->begin < deque->end) {
+        t = steal ? deque->tasks[deque->begin++] : deque->tasks[--deque->end];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return t;
+}
+
+/**
+ * Hands the search after the first depth actions of this thread's protocol to its deque.
+ */
+void spawnTask(unsigned int depth) {
+    struct task *t = malloc(sizeof(struct task));
+    t->depth = depth;
+    t->startState = *startState;
+    t->steps = malloc(depth * sizeof(struct protocolStep));
+    for (unsigned int i = 0; i < depth; i++) {
+        t->steps[i] = protocol[i];
+        t->steps[i].perms = NULL;
+        if (protocol[i].action == SHUFFLE) {
+            t->steps[i].perms = malloc(protocol[i].permSetSize * sizeof(unsigned int));
+            memcpy(t->steps[i].perms, protocol[i].perms,
+                   protocol[i].permSetSize * sizeof(unsigned int));
+        }
+    }
+    spawnedTasks++;
+    pushTask(&taskDeques[workerIndex], t);
+}
+
+/**
+ * Continues the search after the first depth actions. While other threads may run out of
+ * work, or while a checkpoint is pending, the remaining search is handed to the task deque
+ * instead.
+ */
+unsigned int searchFrom(unsigned int depth) {
+    if (depth >= maxLength) {
+        return 0;
+    }
+    if (atomic_load_explicit(&checkpointRequested, memory_order_relaxed)
+        || atomic_load_explicit(&pendingTasks, memory_order_relaxed)
+           < TASKS_PER_THREAD * numberThreads) {
+        spawnTask(depth);
+        return 0;
+    }
+    return performActions(depth);
+}
+
+/**
+ * Prints the protocol consisting of the first length actions and its result columns.
+ */
+void printProtocol(unsigned int length, unsigned int resA, unsigned int resB) {
+    printf("Found protocol with %u actions.\n", length);
+    printf("  Start state:\n");
+    printState(startState);
+    for (unsigned int i = 0; i < length; i++) {
+        const struct protocolStep *step = &protocol[i];
+        if (step->action == TURN) {
+            printf("  %u: TURN position %u, observed symbol %u\n",
+                   i + 1, step->turnPosition + 1, step->observation);
+        } else {
+            printf("  %u: SHUFFLE with %u permutation(s):", i + 1, step->permSetSize);
+            for (unsigned int j = 0; j < step->permSetSize; j++) {
+                printf(" [");
+                for (unsigned int k = 0; k < N; k++) {
+                    printf("%s%u", k ? " " : "", permutations[step->perms[j]][k] + 1);
+                }
+                printf("]");
+            }
+            printf("\n");
+        }
+        printState(&step->state);
+    }
+    printf("  RESULT: positions %u and %u encode the output bit.\n", resA + 1, resB + 1);
+}
+
+/**
+ * Returns the seconds the search has run, including the time before it was resumed.
+ */
+double elapsedSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return resumedSeconds + (double)(now.tv_sec - searchBegin.tv_sec)
+           + (now.tv_nsec - searchBegin.tv_nsec) / 1e9;
+}
+
+/**
+ * Writes the state as the bitset of its possible sequences.
+ */
+void getPossibleSequences(const struct state *s, uint64_t *words) {
+    for (unsigned int i = 0; i < NUMBER_POSSIBLE_SEQUENCES; i++) {
+        if (isStillPossible(s, i)) {
+            words[i / 64] |= (uint64_t)1 << (i % 64);
+        }
+    }
+}
+
+/**
+ * Writes the protocol consisting of the first length actions to recordPath.
+ */
+void recordProtocol(unsigned int length, unsigned int resA, unsigned int resB) {
+    struct protocolRecord record;
+    initProtocolRecord(&record);
+    record.n = N;
+    record.numSym = NUM_SYM;
+    record.maxLength = L;
+    record.engine = RECORD_ENGINE_NATIVE;
+    record.seconds = elapsedSeconds();
+    record.numberResults = 2;
+    record.results[0] = resA;
+    record.results[1] = resB;
+    record.sequenceWords = (NUMBER_POSSIBLE_SEQUENCES + 63) / 64;
+    record.startState = calloc(record.sequenceWords, sizeof(uint64_t));
+    getPossibleSequences(startState, record.startState);
+    record.length = length;
+    record.actions = calloc(length, sizeof(struct recordAction));
+    for (unsigned int i = 0; i < length; i++) {
+        const struct protocolStep *step = &protocol[i];
+        struct recordAction *action = &record.actions[i];
+        action->type = step->action == TURN ? RECORD_TURN : RECORD_SHUFFLE;
+        if (step->action == TURN) {
+            action->position = step->turnPosition;
+            action->branch = step->observation - 1;
+        } else {
+            action->permSetSize = step->permSetSize;
+            action->permutations = malloc(step->permSetSize * sizeof(unsigned int));
+            memcpy(action->permutations, step->perms, step->permSetSize * sizeof(unsigned int));
+        }
+        action->state = calloc(record.sequenceWords, sizeof(uint64_t));
+        getPossibleSequences(&step->state, action->state);
+    }
+    writeProtocolRecord(recordPath, &record);
+    freeProtocolRecord(&record);
+}
+
+/**
+ * Prints (and records) the protocol of this thread, unless another thread has already
+ * found one.
+ */
+void reportProtocol(unsigned int length, unsigned int resA, unsigned int resB) {
+    if (!atomic_exchange(&protocolFound, 1)) {
+        printProtocol(length, resA, resB);
+        if (recordPath) {
+            recordProtocol(length, resA, resB);
+        }
+    }
+}
+
+/**
+ * Evaluates the state reached by the shuffle at protocol[depth] and continues the search.
+ */
+unsigned int continueAfterShuffle(unsigned int depth) {
+    struct protocolStep *step = &protocol[depth];
+    exploredStates++;
+    // The symbolic models assume that shuffles never produce bottom sequences.
+    if (!isBottomFree(&step->state)) {
+        return 0;
+    }
+    unsigned int a, b;
+    if (isFinalState(&step->state, &a, &b)) {
+        reportProtocol(depth + 1, a, b);
+        return 1;
+    }
+    return searchFrom(depth + 1);
+}
+
+/**
+ * Enumerates arbitrary permutation sets with indices larger than last recursively.
+ * The partial result of the first setSize permutations is stored in partial[setSize].
+ * Since bottom sequences can only be added by further permutations, we prune early.
+ */
+unsigned int enumeratePermutationSets(const struct state *s, unsigned int depth,
+                                      unsigned int setSize, unsigned int last) {
+    struct protocolStep *step = &protocol[depth];
+    struct state *partial = &partialShuffleStates[depth * (MAX_PERM_SET_SIZE + 1)];
+    for (unsigned int p = (setSize ? last + 1 : 0); p < NUMBER_POSSIBLE_PERMUTATIONS; p++) {
+        struct state *res = &partial[setSize + 1];
+        *res = partial[setSize];
+        for (unsigned int i = 0; i < NUMBER_POSSIBLE_SEQUENCES; i++) {
+            if (isStillPossible(s, i)) {
+                addPermutedSequence(s, i, p, res);
+            }
+        }
+        if (!isBottomFree(res)) {
+            continue;
+        }
+        step->perms[setSize] = p;
+        step->permSetSize = setSize + 1;
+        step->state = *res;
+        finishShuffle(s, setSize + 1, &step->state);
+        if (continueAfterShuffle(depth)) {
+            return 1;
+        }
+        if (setSize + 1 < MAX_PERM_SET_SIZE
+            && enumeratePermutationSets(s, depth, setSize + 1, p)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Try all shuffle operations on the state before protocol[depth].
+ */
+unsigned int applyShuffle(const struct state *s, unsigned int depth) {
+    struct protocolStep *step = &protocol[depth];
+    step->action = SHUFFLE;
+    if (CLOSED_PROTOCOL || FORCE_RANDOM_CUTS) {
+        for (unsigned int i = 0; i < numberShuffles; i++) {
+            step->permSetSize = shuffles[i].size;
+            memcpy(step->perms, shuffles[i].perms, shuffles[i].size * sizeof(unsigned int));
+            doClosedShuffle(s, &shuffles[i], &step->state);
+            if (continueAfterShuffle(depth)) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+    getEmptyState(&partialShuffleStates[depth * (MAX_PERM_SET_SIZE + 1)]);
+    return enumeratePermutationSets(s, depth, 0, 0);
+}
+
+/**
+ * Try all turn operations on the state before protocol[depth].
+ */
+unsigned int applyTurn(const struct state *s, unsigned int depth) {
+    struct protocolStep *step = &protocol[depth];
+    step->action = TURN;
+    for (unsigned int turnPosition = 0; turnPosition < N; turnPosition++) {
+        unsigned int cntTurnObservations = countTurnObservations(s, turnPosition);
+        if (cntTurnObservations < MIN_TURN_OBSERVATIONS
+            || cntTurnObservations > MAX_TURN_OBSERVATIONS) {
+            continue;
+        }
+        // Every observation must lead to a secure state, otherwise the turn is not allowed.
+        struct state branches[NUM_SYM];
+        unsigned int isUsed[NUM_SYM] = { 0 };
+        unsigned int secure = 1;
+        unsigned int isFinalTurn = 1;
+        unsigned int a = 0, b = 0;
+        for (unsigned int obs = 1; secure && obs <= NUM_SYM; obs++) {
+            if (!copyObservation(s, turnPosition, obs, &branches[obs - 1])) {
+                // Observations which cannot occur are not used.
+                unsigned int occurs = 0;
+                for (unsigned int i = 0; !occurs && i < NUMBER_POSSIBLE_SEQUENCES; i++) {
+                    occurs = isStillPossible(s, i) && sequences[i][turnPosition] == obs;
+                }
+                secure = !occurs;
+            } else {
+                isUsed[obs - 1] = 1;
+                isFinalTurn &= isFinalState(&branches[obs - 1], &a, &b);
+            }
+        }
+        if (!secure) {
+            continue;
+        }
+        step->turnPosition = turnPosition;
+        for (unsigned int obs = 1; obs <= NUM_SYM; obs++) {
+            if (!isUsed[obs - 1]) {
+                continue;
+            }
+            exploredStates++;
+            step->observation = obs;
+            step->state = branches[obs - 1];
+            unsigned int isFinal = FINITE_RUNTIME ? isFinalTurn
+                                                  : isFinalState(&step->state, &a, &b);
+            if (isFinal) {
+                if (FINITE_RUNTIME) {
+                    // All branches are final, we print the one of the last observation.
+                    isFinalState(&step->state, &a, &b);
+                }
+                reportProtocol(depth + 1, a, b);
+                return 1;
+            }
+            if (searchFrom(depth + 1)) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Hashes the contents of a state, which are canonical as all fractions are reduced.
+ */
+uint64_t hashState(const struct state *s, uint64_t seed) {
+    const unsigned char *bytes = (const unsigned char *)s;
+    uint64_t h = seed;
+    for (size_t i = 0; i + sizeof(uint64_t) <= sizeof(struct state); i += sizeof(uint64_t)) {
+        // Copying the words keeps the access legal for both state representations.
+        uint64_t word;
+        memcpy(&word, bytes + i, sizeof(word));
+        h = (h ^ word) * 0x9E3779B97F4A7C15ull;
+        h ^= h >> 29;
+    }
+    return h ^ (h >> 32);
+}
+
+/**
+ * Stores the 128-bit hash of s in (key, check) if it is smaller than the current one.
+ */
+void minimizeHash(const struct state *s, uint64_t *key, uint64_t *check) {
+    uint64_t k = hashState(s, 0x243F6A8885A308D3ull);
+    uint64_t c = hashState(s, 0x13198A2E03707344ull);
+    if (k < *key || (k == *key && c < *check)) {
+        *key = k;
+        *check = c;
+    }
+}
+
+/**
+ * Computes the slot of the transposition table for the state s. With SYMMETRY_REDUCTION,
+ * the smallest hash of all relabelings of s is used, such that equivalent states share it.
+ */
+size_t findTransposition(const struct state *s, uint64_t *key, uint64_t *check) {
+    *key = UINT64_MAX;
+    *check = UINT64_MAX;
+    if (!SYMMETRY_REDUCTION) {
+        minimizeHash(s, key, check);
+    }
+    for (unsigned int p = 0; SYMMETRY_REDUCTION && p < NUMBER_POSSIBLE_PERMUTATIONS; p++) {
+        struct state relabeled;
+        doShuffle(s, &p, 1, &relabeled);
+        minimizeHash(&relabeled, key, check);
+        if (SWAP_COLORS) {
+            struct state swapped;
+            swapColors(&relabeled, &swapped);
+            minimizeHash(&swapped, key, check);
+        }
+    }
+    return *key & (transpositionSlots - 1);
+}
+
+/**
+ * Returns the number of remaining actions for which the state with the given check hash,
+ * stored from the given slot on, is known to fail, or 0 if it is not known.
+ */
+unsigned int lookupTransposition(size_t slot, uint64_t check) {
+    uint64_t fingerprint = check & ~TRANSPOSITION_REMAINING;
+    for (unsigned int p = 0; p < TRANSPOSITION_PROBES; p++) {
+        uint64_t entry = atomic_load_explicit(&transpositionTable[(slot + p) & (transpositionSlots - 1)],
+                                              memory_order_relaxed);
+        if ((entry & ~TRANSPOSITION_REMAINING) == fingerprint && entry) {
+            return entry & TRANSPOSITION_REMAINING;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Remembers that no protocol with at most remaining actions exists from the state. If all
+ * probed slots are taken by other states, the one with the fewest remaining actions
+ * (i.e., the cheapest to search again) is replaced.
+ */
+void storeTransposition(size_t slot, uint64_t check, unsigned int remaining) {
+    uint64_t fingerprint = check & ~TRANSPOSITION_REMAINING;
+    uint64_t desired = fingerprint | remaining;
+    _Atomic uint64_t *victim = NULL;
+    uint64_t victimEntry = 0;
+    for (unsigned int p = 0; p < TRANSPOSITION_PROBES; p++) {
+        _Atomic uint64_t *target = &transpositionTable[(slot + p) & (transpositionSlots - 1)];
+        uint64_t entry = atomic_load_explicit(target, memory_order_relaxed);
+        // A failed exchange reloads the entry, which is then examined again.
+        while (!entry || (entry & ~TRANSPOSITION_REMAINING) == fingerprint) {
+            if (entry && (entry & TRANSPOSITION_REMAINING) >= remaining) {
+                return;
+            }
+            if (atomic_compare_exchange_weak(target, &entry, desired)) {
+                return;
+            }
+        }
+        if (!victim || (entry & TRANSPOSITION_REMAINING) < (victimEntry & TRANSPOSITION_REMAINING)) {
+            victim = target;
+            victimEntry = entry;
+        }
+    }
+    // If another thread changed the victim in the meantime, the state is not stored.
+    atomic_compare_exchange_strong(victim, &victimEntry, desired);
+}
+
+/**
+ * Allocates the transposition table with a power of two of slots: 2^14 per sequence and
+ * protocol step, but at most TRANSPOSITION_TABLE_MEGABYTES.
+ */
+void initTranspositionTable() {
+    unsigned long long budget = (unsigned long long)TRANSPOSITION_TABLE_MEGABYTES << 20;
+    unsigned long long wanted = (unsigned long long)NUMBER_POSSIBLE_SEQUENCES * L << 14;
+    transpositionSlots = 0;
+    for (unsigned long long slots = 1; slots * sizeof(uint64_t) <= budget; slots *= 2) {
+        transpositionSlots = slots;
+        if (slots >= wanted) {
+            break;
+        }
+    }
+    if (transpositionSlots >= TRANSPOSITION_PROBES) {
+        transpositionTable = calloc(transpositionSlots, sizeof(uint64_t));
+    }
+}
+
+/**
+ * Configuration a checkpoint was written with. It is only resumed with the same one.
+ */
+static const unsigned int checkpointConfiguration[] = {
+    N, NUM_SYM, L, WEAK_SECURITY, FINITE_RUNTIME, CLOSED_PROTOCOL, FORCE_RANDOM_CUTS,
+    MAX_PERM_SET_SIZE, MIN_TURN_OBSERVATIONS, MAX_TURN_OBSERVATIONS, ITERATIVE_DEEPENING,
+    SYMMETRY_REDUCTION, TRANSPOSITION_PROBES, sizeof(struct state)
+};
+#define CHECKPOINT_VERSION 1
+
+/**
+ * Writes the checkpoint to checkpointPath while all workers are paused:
+ *   char     magic[4]        "NSCP"
+ *   uint32_t version, configuration[]
+ *   uint32_t maxLength       the current bound of the (iterative deepening) search
+ *   uint64_t exploredStates
+ *   double   seconds
+ *   uint64_t numberTasks, followed by every task of the deques:
+ *     uint32_t depth, struct state startState,
+ *     per step: uint32_t action, turnPosition, observation, permSetSize,
+ *               uint32_t perms[permSetSize] (shuffles only), struct state state
+ *   uint64_t transpositionSlots, numberEntries, followed by (uint64_t slot, entry) pairs
+ * It is written to a temporary file first and then renamed, such that a checkpoint is
+ * never lost to a crash while it is written.
+ */
+void writeCheckpoint() {
+    char temporary[4096];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", checkpointPath);
+    FILE *out = fopen(temporary, "wb");
+    if (!out) {
+        fprintf(stderr, "Cannot write %s.\n", temporary);
+        return;
+    }
+    uint32_t version = CHECKPOINT_VERSION;
+    uint32_t bound = maxLength;
+    fwrite("NSCP", 1, 4, out);
+    fwrite(&version, sizeof(uint32_t), 1, out);
+    for (size_t i = 0; i < sizeof(checkpointConfiguration) / sizeof(unsigned int); i++) {
+        uint32_t value = checkpointConfiguration[i];
+        fwrite(&value, sizeof(uint32_t), 1, out);
+    }
+    fwrite(&bound, sizeof(uint32_t), 1, out);
+    uint64_t explored = atomic_load(&totalExploredStates);
+    double seconds = elapsedSeconds();
+    fwrite(&explored, sizeof(uint64_t), 1, out);
+    fwrite(&seconds, sizeof(double), 1, out);
+
+    uint64_t numberTasks = 0;
+    for (unsigned int i = 0; i < numberThreads; i++) {
+        numberTasks += taskDeques[i].end - taskDeques[i].begin;
+    }
+    fwrite(&numberTasks, sizeof(uint64_t), 1, out);
+    for (unsigned int i = 0; i < numberThreads; i++) {
+        for (unsigned int j = taskDeques[i].begin; j < taskDeques[i].end; j++) {
+            const struct task *t = taskDeques[i].tasks[j];
+            uint32_t depth = t->depth;
+            fwrite(&depth, sizeof(uint32_t), 1, out);
+            fwrite(&t->startState, sizeof(struct state), 1, out);
+            for (unsigned int k = 0; k < t->depth; k++) {
+                const struct protocolStep *step = &t->steps[k];
+                uint32_t fields[] = { step->action, step->turnPosition, step->observation,
+                                      step->action == SHUFFLE ? step->permSetSize : 0 };
+                fwrite(fields, sizeof(uint32_t), 4, out);
+                for (unsigned int p = 0; p < fields[3]; p++) {
+                    uint32_t perm = step->perms[p];
+                    fwrite(&perm, sizeof(uint32_t), 1, out);
+                }
+                fwrite(&step->state, sizeof(struct state), 1, out);
+            }
+        }
+    }
+
+    uint64_t slots = transpositionTable ? transpositionSlots : 0;
+    uint64_t numberEntries = 0;
+    for (uint64_t i = 0; i < slots; i++) {
+        numberEntries += atomic_load_explicit(&transpositionTable[i], memory_order_relaxed) != 0;
+    }
+    fwrite(&slots, sizeof(uint64_t), 1, out);
+    fwrite(&numberEntries, sizeof(uint64_t), 1, out);
+    for (uint64_t i = 0; i < slots; i++) {
+        uint64_t entry[] = { i, atomic_load_explicit(&transpositionTable[i], memory_order_relaxed) };
+        if (entry[1]) {
+            fwrite(entry, sizeof(uint64_t), 2, out);
+        }
+    }
+    unsigned int written = !ferror(out) && !fflush(out) && !fsync(fileno(out));
+    written &= !fclose(out);
+    if (!written || rename(temporary, checkpointPath)) {
+        fprintf(stderr, "Cannot write %s.\n", checkpointPath);
+        remove(temporary);
+        return;
+    }
+    printf("Checkpoint: bound %u, %llu pending tasks, %llu states explored in %.0f seconds.\n",
+           maxLength, (unsigned long long)numberTasks, (unsigned long long)explored, seconds);
+    fflush(stdout);
+}
+
+/**
+ * Reads one step of a task from the checkpoint. Returns 0 if it is invalid.
+ */
+unsigned int readCheckpointStep(FILE *in, struct protocolStep *step) {
+    uint32_t fields[4];
+    step->perms = NULL;
+    if (fread(fields, sizeof(uint32_t), 4, in) != 4 || fields[3] > MAX_PERM_SET_SIZE) {
+        return 0;
+    }
+    step->action = fields[0];
+    step->turnPosition = fields[1];
+    step->observation = fields[2];
+    step->permSetSize = fields[3];
+    if (step->action == SHUFFLE) {
+        step->perms = malloc((step->permSetSize + 1) * sizeof(unsigned int));
+        for (unsigned int p = 0; p < step->permSetSize; p++) {
+            uint32_t perm;
+            if (fread(&perm, sizeof(uint32_t), 1, in) != 1
+                || perm >= NUMBER_POSSIBLE_PERMUTATIONS) {
+                return 0;
+            }
+            step->perms[p] = perm;
+        }
+    }
+    return fread(&step->state, sizeof(struct state), 1, in) == 1;
+}
+
+/**
+ * Loads the checkpoint at checkpointPath: the bound, the statistics and the transposition
+ * table are restored and the frontier is distributed over the deques.
+ * Returns 1 if it was loaded, 0 if there is none and -1 if it is invalid.
+ */
+int loadCheckpoint() {
+    FILE *in = fopen(checkpointPath, "rb");
+    if (!in) {
+        return 0;
+    }
+    char magic[4];
+    uint32_t version, bound;
+    unsigned int valid = fread(magic, 1, 4, in) == 4 && !memcmp(magic, "NSCP", 4)
+                         && fread(&version, sizeof(uint32_t), 1, in) == 1
+                         && version == CHECKPOINT_VERSION;
+    for (size_t i = 0; valid && i < sizeof(checkpointConfiguration) / sizeof(unsigned int); i++) {
+        uint32_t value;
+        valid = fread(&value, sizeof(uint32_t), 1, in) == 1 && value == checkpointConfiguration[i];
+    }
+    uint64_t explored, numberTasks;
+    valid = valid && fread(&bound, sizeof(uint32_t), 1, in) == 1 && bound >= 1 && bound <= L
+            && fread(&explored, sizeof(uint64_t), 1, in) == 1
+            && fread(&resumedSeconds, sizeof(double), 1, in) == 1
+            && fread(&numberTasks, sizeof(uint64_t), 1, in) == 1;
+    for (uint64_t i = 0; valid && i < numberTasks; i++) {
+        struct task *t = calloc(1, sizeof(struct task));
+        uint32_t depth;
+        valid = fread(&depth, sizeof(uint32_t), 1, in) == 1 && depth < bound
+                && fread(&t->startState, sizeof(struct state), 1, in) == 1;
+        t->steps = calloc(valid ? depth + 1 : 1, sizeof(struct protocolStep));
+        for (t->depth = 0; valid && t->depth < depth; t->depth++) {
+            valid = readCheckpointStep(in, &t->steps[t->depth]);
+        }
+        // Incomplete tasks are pushed as well, they are dropped with all others below.
+        pushTask(&taskDeques[i % numberThreads], t);
+    }
+    uint64_t slots = 0, numberEntries = 0;
+    valid = valid && fread(&slots, sizeof(uint64_t), 1, in) == 1
+            && fread(&numberEntries, sizeof(uint64_t), 1, in) == 1;
+    // A table of another size (or none) is dropped, which only costs search time.
+    unsigned int restore = valid && transpositionTable && slots == transpositionSlots;
+    for (uint64_t i = 0; restore && i < numberEntries; i++) {
+        uint64_t entry[2];
+        valid = fread(entry, sizeof(uint64_t), 2, in) == 2 && entry[0] < slots;
+        restore = valid;
+        if (valid) {
+            atomic_store_explicit(&transpositionTable[entry[0]], entry[1], memory_order_relaxed);
+        }
+    }
+    fclose(in);
+    if (!valid) {
+        for (unsigned int i = 0; i < numberThreads; i++) {
+            struct task *t;
+            while ((t = takeTask(&taskDeques[i], 0))) {
+                for (unsigned int j = 0; j <= t->depth; j++) {
+                    free(t->steps[j].perms);
+                }
+                free(t->steps);
+                free(t);
+            }
+        }
+        atomic_store(&pendingTasks, 0);
+        if (transpositionTable) {
+            memset((void *)transpositionTable, 0, transpositionSlots * sizeof(uint64_t));
+        }
+        resumedSeconds = 0;
+        return -1;
+    }
+    maxLength = bound;
+    atomic_store(&totalExploredStates, explored);
+    printf("Resuming from %s: bound %u, %llu pending tasks, %llu states explored in %.0f"
+           " seconds.\n", checkpointPath, bound, (unsigned long long)numberTasks,
+           (unsigned long long)explored, resumedSeconds);
+    return 1;
+}
+
+/**
+ * Once all running workers are paused for a requested checkpoint, it is written (unless the
+ * search is already decided) and the workers are released. Called with checkpointLock held.
+ */
+void completeCheckpoint() {
+    if (!atomic_load(&checkpointRequested) || pausedWorkers < runningWorkers) {
+        return;
+    }
+    if (!atomic_load(&protocolFound) && atomic_load(&pendingTasks)) {
+        writeCheckpoint();
+    }
+    clock_gettime(CLOCK_MONOTONIC, &lastCheckpoint);
+    pausedWorkers = 0;
+    checkpointGeneration++;
+    atomic_store(&checkpointRequested, 0);
+    pthread_cond_broadcast(&checkpointDone);
+}
+
+/**
+ * Pauses this worker until the requested checkpoint is written.
+ */
+void pauseForCheckpoint() {
+    atomic_fetch_add(&totalExploredStates, exploredStates);
+    exploredStates = 0;
+    pthread_mutex_lock(&checkpointLock);
+    unsigned long long generation = checkpointGeneration;
+    pausedWorkers++;
+    completeCheckpoint();
+    while (generation == checkpointGeneration) {
+        pthread_cond_wait(&checkpointDone, &checkpointLock);
+    }
+    pthread_mutex_unlock(&checkpointLock);
+}
+
+/**
+ * Handler of SIGTERM and SIGINT: takes a last checkpoint and stops the search.
+ */
+void requestStop(int signal) {
+    (void)signal;
+    atomic_store(&checkpointRequested, 1);
+    stopRequested = 1;
+}
+
+/**
+ * Apply nondeterministic actions from protocol step depth on until a final state is reached.
+ * Finding a final state after fewer than L actions corresponds to a protocol of L actions in
+ * the symbolic model, padded by identity shuffles or, with SYMMETRY_BREAKING, ending early.
+ * States from which no protocol with the remaining actions exists are remembered in the
+ * transposition table, so that they are pruned when they are reached again. This does not
+ * hold for states whose subtrees were partly handed to other tasks.
+ */
+unsigned int performActions(unsigned int depth) {
+    const struct state *s = depth ? &protocol[depth - 1].state : startState;
+    unsigned int remaining = maxLength - depth;
+    if (atomic_load_explicit(&protocolFound, memory_order_relaxed)) {
+        return 1;
+    }
+    if (!transpositionTable) {
+        return applyTurn(s, depth) || applyShuffle(s, depth);
+    }
+    uint64_t key, check;
+    size_t slot = findTransposition(s, &key, &check);
+    if (lookupTransposition(slot, check) >= remaining) {
+        return 0;
+    }
+    unsigned long long spawned = spawnedTasks;
+    if (applyTurn(s, depth) || applyShuffle(s, depth)) {
+        return 1;
+    }
+    if (spawnedTasks == spawned) {
+        storeTransposition(slot, check, remaining);
+    }
+    return 0;
+}
+
+/**
+ * One bit is represented by two cards, the bit is "0" iff the first card is lower.
+ * Returns the two cards of the given player for the given bit.
+ */
+void commitBit(unsigned int arr[N], unsigned int player, unsigned int bit) {
+    unsigned int low = (NUM_SYM == 2) ? 1 : 2 * player + 1;
+    arr[2 * player] = bit ? low + 1 : low;
+    arr[2 * player + 1] = bit ? low : low + 1;
+}
+
+/**
+ * Builds the start state with the given arrangement of the additional (helper) cards.
+ */
+void getStartState(const unsigned int helpers[N], struct state *s) {
+    getEmptyState(s);
+    for (unsigned int i = 0; i < NUMBER_START_SEQS; i++) {
+        unsigned int start[N];
+        commitBit(start, 0, i >> 1);
+        commitBit(start, 1, i & 1);
+        memcpy(&start[COMMIT], helpers, (N - COMMIT) * sizeof(unsigned int));
+        unsigned int idx = getSequenceIndexFromArray(start);
+        // For output possibilistic security, we assign every sequence to its output (AND).
+        unsigned int pos = (WEAK_SECURITY != 2) ? i : (i == NUMBER_START_SEQS - 1);
+        setProbability(s, idx, pos);
+    }
+}
+
+#if WEAK_SECURITY
+/**
+ * Partitions all sequences into the orbits of the closed shuffle sh, as long as the orbit
+ * tables stay within MAX_ORBIT_TABLE_ENTRIES. Otherwise, the shuffle is applied by doShuffle.
+ */
+void initOrbits(struct shuffle *sh) {
+    unsigned int *orbitOf = malloc(NUMBER_POSSIBLE_SEQUENCES * sizeof(unsigned int));
+    unsigned int numberOrbits = 0;
+    for (unsigned int i = 0; i < NUMBER_POSSIBLE_SEQUENCES; i++) {
+        orbitOf[i] = UINT_MAX;
+    }
+    for (unsigned int i = 0; i < NUMBER_POSSIBLE_SEQUENCES; i++) {
+        if (orbitOf[i] == UINT_MAX) {
+            for (unsigned int j = 0; j < sh->size; j++) {
+                orbitOf[applyPermutation(sh->perms[j], i)] = numberOrbits;
+            }
+            numberOrbits++;
+        }
+    }
+    unsigned long long entries = NUMBER_POSSIBLE_SEQUENCES
+                                 + (unsigned long long)numberOrbits * SEQUENCE_WORDS;
+    if (orbitTableEntries + entries > MAX_ORBIT_TABLE_ENTRIES) {
+        free(orbitOf);
+        return;
+    }
+    orbitTableEntries += entries;
+    sh->numberOrbits = numberOrbits;
+    sh->orbitOf = orbitOf;
+    sh->orbitMasks = calloc((size_t)numberOrbits * SEQUENCE_WORDS, sizeof(uint64_t));
+    for (unsigned int i = 0; i < NUMBER_POSSIBLE_SEQUENCES; i++) {
+        sh->orbitMasks[(size_t)orbitOf[i] * SEQUENCE_WORDS + i / 64] |= (uint64_t)1 << (i % 64);
+    }
+}
+
+#endif
+
+/**
+ * Adds the shuffle with the given permutations to the list of searched shuffles.
+ * All shuffles with more than one permutation must be closed, i.e., form a group.
+ */
+void addShuffle(const unsigned int *perms, unsigned int size) {
+    shuffles = realloc(shuffles, (numberShuffles + 1) * sizeof(struct shuffle));
+    struct shuffle *sh = &shuffles[numberShuffles++];
+    sh->size = size;
+    sh->perms = malloc(size * sizeof(unsigned int));
+    memcpy(sh->perms, perms, size * sizeof(unsigned int));
+    sh->numberOrbits = 0;
+    sh->orbitOf = NULL;
+    sh->orbitMasks = NULL;
+#if WEAK_SECURITY
+    if (size > 1) {
+        initOrbits(sh);
+    }
+#endif
+}
+
+int compareUints(const void *a, const void *b) {
+    unsigned int x = *(const unsigned int *)a;
+    unsigned int y = *(const unsigned int *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Computes the group generated by the elements of a subgroup and the given generators.
+ * The elements are stored in (and read from) elements, the bitset member marks all of them.
+ * Returns the group size, or 0 if it exceeds MAX_PERM_SET_SIZE.
+ */
+unsigned int closeSubgroup(unsigned int *elements, unsigned int size,
+                           const unsigned int *generators, unsigned int numberGenerators,
+                           uint64_t *member) {
+    memset(member, 0, PERMUTATION_WORDS * sizeof(uint64_t));
+    for (unsigned int i = 0; i < size; i++) {
+        addMember(member, elements[i]);
+    }
+    for (unsigned int i = 0; i < size; i++) {
+        for (unsigned int g = 0; g < numberGenerators; g++) {
+            unsigned int p = combinePermutations(elements[i], generators[g]);
+            if (!isMember(member, p)) {
+                if (size == MAX_PERM_SET_SIZE) {
+                    return 0;
+                }
+                addMember(member, p);
+                elements[size++] = p;
+            }
+        }
+    }
+    return size;
+}
+
+/**
+ * Enumerates all subgroups of S_N up to MAX_PERM_SET_SIZE elements by repeatedly
+ * extending known subgroups with one further permutation.
+ */
+void addClosedShuffles() {
+    unsigned int capacity = 64;
+    unsigned int count = 1;
+    unsigned int **elements = malloc(capacity * sizeof(unsigned int *));
+    unsigned int **generators = malloc(capacity * sizeof(unsigned int *));
+    unsigned int *sizes = malloc(capacity * sizeof(unsigned int));
+    unsigned int *numberGenerators = malloc(capacity * sizeof(unsigned int));
+    uint64_t member[PERMUTATION_WORDS];
+    uint64_t contained[PERMUTATION_WORDS];
+    unsigned int *buffer = malloc(MAX_PERM_SET_SIZE * sizeof(unsigned int));
+
+    // Start with the trivial group which only contains the identity.
+    elements[0] = calloc(1, sizeof(unsigned int));
+    generators[0] = NULL;
+    sizes[0] = 1;
+    numberGenerators[0] = 0;
+    for (unsigned int h = 0; h < count; h++) {
+        memset(contained, 0, sizeof(contained));
+        for (unsigned int i = 0; i < sizes[h]; i++) {
+            addMember(contained, elements[h][i]);
+        }
+        for (unsigned int g = 1; g < NUMBER_POSSIBLE_PERMUTATIONS; g++) {
+            if (isMember(contained, g)) {
+                continue;
+            }
+            unsigned int gens[32];
+            memcpy(gens, generators[h], numberGenerators[h] * sizeof(unsigned int));
+            gens[numberGenerators[h]] = g;
+            memcpy(buffer, elements[h], sizes[h] * sizeof(unsigned int));
+            unsigned int size = closeSubgroup(buffer, sizes[h], gens,
+                                              numberGenerators[h] + 1, member);
+            if (!size) {
+                continue;
+            }
+            qsort(buffer, size, sizeof(unsigned int), compareUints);
+            unsigned int known = 0;
+            for (unsigned int k = 0; !known && k < count; k++) {
+                known = sizes[k] == size
+                        && !memcmp(elements[k], buffer, size * sizeof(unsigned int));
+            }
+            if (known) {
+                continue;
+            }
+            if (count == capacity) {
+                capacity *= 2;
+                elements = realloc(elements, capacity * sizeof(unsigned int *));
+                generators = realloc(generators, capacity * sizeof(unsigned int *));
+                sizes = realloc(sizes, capacity * sizeof(unsigned int));
+                numberGenerators = realloc(numberGenerators, capacity * sizeof(unsigned int));
+            }
+            elements[count] = malloc(size * sizeof(unsigned int));
+            memcpy(elements[count], buffer, size * sizeof(unsigned int));
+            generators[count] = malloc((numberGenerators[h] + 1) * sizeof(unsigned int));
+            memcpy(generators[count], gens, (numberGenerators[h] + 1) * sizeof(unsigned int));
+            sizes[count] = size;
+            numberGenerators[count] = numberGenerators[h] + 1;
+            count++;
+        }
+    }
+    // The trivial group is already contained as single identity permutation.
+    for (unsigned int h = 1; h < count; h++) {
+        addShuffle(elements[h], sizes[h]);
+    }
+    for (unsigned int h = 0; h < count; h++) {
+        free(elements[h]);
+        free(generators[h]);
+    }
+    free(elements);
+    free(generators);
+    free(sizes);
+    free(numberGenerators);
+    free(buffer);
+}
+
+/**
+ * Adds all subgroups of the catalogue with at most MAX_PERM_SET_SIZE elements.
+ * Returns 0 if the catalogue is not available for N cards.
+ */
+unsigned int loadClosedShuffles() {
+    char path[4096];
+    snprintf(path, sizeof(path), SUBGROUP_CATALOGUE, N);
+    FILE *in = fopen(path, "rb");
+    if (!in) {
+        return 0;
+    }
+    char magic[4];
+    uint32_t header[2];
+    if (fread(magic, 1, 4, in) != 4 || memcmp(magic, "SGRP", 4)
+        || fread(header, sizeof(uint32_t), 2, in) != 2 || header[0] != N) {
+        fclose(in);
+        return 0;
+    }
+    uint32_t *orders = malloc(header[1] * sizeof(uint32_t));
+    unsigned int valid = fread(orders, sizeof(uint32_t), header[1], in) == header[1];
+    size_t numberElements = 0;
+    for (unsigned int i = 0; valid && i < header[1]; i++) {
+        valid = orders[i] <= NUMBER_POSSIBLE_PERMUTATIONS;
+        numberElements += orders[i];
+    }
+    uint16_t *elements = malloc(numberElements * sizeof(uint16_t));
+    valid = valid && fread(elements, sizeof(uint16_t), numberElements, in) == numberElements;
+    fclose(in);
+
+    unsigned int *perms = malloc(NUMBER_POSSIBLE_PERMUTATIONS * sizeof(unsigned int));
+    const uint16_t *subgroup = elements;
+    for (unsigned int i = 0; valid && i < header[1]; subgroup += orders[i++]) {
+        // The trivial group is already contained as single identity permutation.
+        if (orders[i] < 2 || orders[i] > MAX_PERM_SET_SIZE) {
+            continue;
+        }
+        for (unsigned int j = 0; j < orders[i]; j++) {
+            perms[j] = subgroup[j];
+        }
+        addShuffle(perms, orders[i]);
+    }
+    if (!valid) {
+        fprintf(stderr, "%s is corrupt, enumerating the subgroups instead.\n", path);
+    }
+    free(orders);
+    free(elements);
+    free(perms);
+    return valid;
+}
+
+/**
+ * Adds all random cuts, i.e., cyclic shifts of the cards on any subset of at least two
+ * positions (in increasing order), while all other cards stay fixed.
+ */
+void addRandomCuts() {
+    for (unsigned int subset = 0; subset < (1u << N); subset++) {
+        unsigned int positions[N];
+        unsigned int m = 0;
+        for (unsigned int k = 0; k < N; k++) {
+            if (subset & (1u << k)) {
+                positions[m++] = k;
+            }
+        }
+        if (m < 2 || m > MAX_PERM_SET_SIZE) {
+            continue;
+        }
+        unsigned int perms[N];
+        for (unsigned int shift = 0; shift < m; shift++) {
+            unsigned int arr[N];
+            for (unsigned int k = 0; k < N; k++) {
+                arr[k] = k;
+            }
+            for (unsigned int i = 0; i < m; i++) {
+                arr[positions[i]] = positions[(i + shift) % m];
+            }
+            perms[shift] = getPermutationIndexFromArray(arr);
+        }
+        qsort(perms, m, sizeof(unsigned int), compareUints);
+        addShuffle(perms, m);
+    }
+}
+
+/**
+ * Collects the shuffles that are searched for closed protocols or random cuts.
+ * As in the symbolic models, a single permutation is always allowed.
+ */
+void initShuffles() {
+    for (unsigned int p = 0; p < NUMBER_POSSIBLE_PERMUTATIONS; p++) {
+        addShuffle(&p, 1);
+    }
+    if (FORCE_RANDOM_CUTS) {
+        addRandomCuts();
+    } else if (CLOSED_PROTOCOL && !loadClosedShuffles()) {
+        addClosedShuffles();
+    }
+}
+
+/**
+ * Runs tasks of the own deque, or stolen from other threads, until all tasks are done
+ * or a protocol was found. Requested checkpoints pause the worker between two tasks.
+ */
+void *runWorker(void *arg) {
+    workerIndex = (unsigned int)(uintptr_t)arg;
+    exploredStates = 0;
+    protocol = calloc(L, sizeof(struct protocolStep));
+    for (unsigned int i = 0; i < L; i++) {
+        protocol[i].perms = malloc(MAX_PERM_SET_SIZE * sizeof(unsigned int));
+    }
+    startState = malloc(sizeof(struct state));
+    if (!CLOSED_PROTOCOL && !FORCE_RANDOM_CUTS) {
+        partialShuffleStates = malloc((size_t)L * (MAX_PERM_SET_SIZE + 1) * sizeof(struct state));
+    }
+    while (atomic_load(&pendingTasks) && !atomic_load(&protocolFound)) {
+        if (atomic_load(&checkpointRequested)) {
+            pauseForCheckpoint();
+            continue;
+        }
+        // A stop is only requested together with a checkpoint, which is written by now.
+        if (stopRequested) {
+            break;
+        }
+        struct task *t = takeTask(&taskDeques[workerIndex], 0);
+        for (unsigned int i = 1; !t && i < numberThreads; i++) {
+            t = takeTask(&taskDeques[(workerIndex + i) % numberThreads], 1);
+        }
+        if (!t) {
+            sched_yield();
+            continue;
+        }
+        *startState = t->startState;
+        for (unsigned int i = 0; i < t->depth; i++) {
+            unsigned int *perms = protocol[i].perms;
+            protocol[i] = t->steps[i];
+            protocol[i].perms = perms;
+            if (t->steps[i].perms) {
+                memcpy(perms, t->steps[i].perms, t->steps[i].permSetSize * sizeof(unsigned int));
+                free(t->steps[i].perms);
+            }
+        }
+        free(t->steps);
+        performActions(t->depth);
+        free(t);
+        atomic_fetch_sub(&pendingTasks, 1);
+    }
+    for (unsigned int i = 0; i < L; i++) {
+        free(protocol[i].perms);
+    }
+    free(protocol);
+    free(startState);
+    free(partialShuffleStates);
+    atomic_fetch_add(&totalExploredStates, exploredStates);
+    pthread_mutex_lock(&checkpointLock);
+    runningWorkers--;
+    completeCheckpoint();
+    if (!runningWorkers) {
+        pthread_cond_broadcast(&checkpointDone);
+    }
+    pthread_mutex_unlock(&checkpointLock);
+    return NULL;
+}
+
+/**
+ * Searches protocols of at most maxLength actions from all start states with the given
+ * arrangements of the additional cards, using numberThreads threads. If resumed is set,
+ * the deques already hold the frontier of a checkpoint instead. While the workers run,
+ * a checkpoint is requested every CHECKPOINT_SECONDS.
+ */
+unsigned int searchProtocol(const unsigned int helpers[N], unsigned int resumed) {
+    unsigned int arr[N];
+    memcpy(arr, helpers, sizeof(arr));
+    unsigned int next = 0;
+    do {
+        if (resumed) {
+            break;
+        }
+        struct task *t = malloc(sizeof(struct task));
+        t->depth = 0;
+        t->steps = NULL;
+        getStartState(arr, &t->startState);
+        pushTask(&taskDeques[next++ % numberThreads], t);
+    } while (NUM_SYM == 2 && nextArrangement(arr, N - COMMIT));
+
+    runningWorkers = numberThreads;
+    pthread_t *threads = malloc(numberThreads * sizeof(pthread_t));
+    for (unsigned int i = 0; i < numberThreads; i++) {
+        pthread_create(&threads[i], NULL, runWorker, (void *)(uintptr_t)i);
+    }
+    pthread_mutex_lock(&checkpointLock);
+    while (checkpointPath && runningWorkers) {
+        struct timespec now, deadline;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long long left = lastCheckpoint.tv_sec + CHECKPOINT_SECONDS - now.tv_sec;
+        if (left <= 0) {
+            atomic_store(&checkpointRequested, 1);
+            left = CHECKPOINT_SECONDS;
+        }
+        // The condition is broadcast for every checkpoint and once the last worker ends.
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += left;
+        pthread_cond_timedwait(&checkpointDone, &checkpointLock, &deadline);
+    }
+    pthread_mutex_unlock(&checkpointLock);
+    for (unsigned int i = 0; i < numberThreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    // Tasks which are left over after a protocol was found are dropped.
+    for (unsigned int i = 0; i < numberThreads; i++) {
+        struct task *t;
+        while ((t = takeTask(&taskDeques[i], 0))) {
+            for (unsigned int j = 0; j < t->depth; j++) {
+                free(t->steps[j].perms);
+            }
+            free(t->steps);
+            free(t);
+        }
+    }
+    atomic_store(&pendingTasks, 0);
+    return atomic_load(&protocolFound);
+}
+
+/**
+ * Usage: nativeSearch [-r record] [-c checkpoint [--resume]], where the found protocol is
+ * written to the file record (see ../shared/protocolRecord.c) and the search is saved to the
+ * file checkpoint every CHECKPOINT_SECONDS and when it is stopped by SIGTERM or SIGINT.
+ * With --resume, the search continues from the checkpoint if it exists.
+ */
+int main(int argc, char **argv) {
+    unsigned int resume = 0;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (!strcmp(argv[i], "-c") && i + 1 < argc) {
+            checkpointPath = argv[++i];
+        } else if (!strcmp(argv[i], "--resume")) {
+            resume = 1;
+        } else {
+            fprintf(stderr, "Usage: %s [-r record] [-c checkpoint [--resume]]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (resume && !checkpointPath) {
+        fprintf(stderr, "--resume requires a checkpoint (-c).\n");
+        return 2;
+    }
+    initTables();
+    initActionTable();
+    initCayleyTable();
+    if (CLOSED_PROTOCOL || FORCE_RANDOM_CUTS) {
+        initShuffles();
+        printf("Searching %u shuffles per shuffle action.\n", numberShuffles);
+    }
+    numberThreads = THREADS ? THREADS : (unsigned int)sysconf(_SC_NPROCESSORS_ONLN);
+    taskDeques = calloc(numberThreads, sizeof(struct taskDeque));
+    for (unsigned int i = 0; i < numberThreads; i++) {
+        pthread_mutex_init(&taskDeques[i].lock, NULL);
+    }
+
+    // The additional cards are free, so we try every arrangement of the remaining symbols.
+    unsigned int helpers[N];
+    unsigned int pos = 0;
+    for (unsigned int i = 0; i < NUM_SYM; i++) {
+        unsigned int remaining = symbolCount[i] - (NUM_SYM == 2 ? 2 : (i < COMMIT));
+        for (unsigned int j = 0; j < remaining; j++) {
+            helpers[pos++] = i + 1;
+        }
+    }
+    initTranspositionTable();
+    maxLength = ITERATIVE_DEEPENING ? 1 : L;
+    int resumed = resume ? loadCheckpoint() : 0;
+    if (resumed < 0) {
+        fprintf(stderr, "%s is not a checkpoint of this configuration.\n", checkpointPath);
+        return 2;
+    }
+    if (checkpointPath) {
+        signal(SIGTERM, requestStop);
+        signal(SIGINT, requestStop);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &searchBegin);
+    lastCheckpoint = searchBegin;
+    unsigned int foundValidProtocol = 0;
+    for (; !foundValidProtocol && !stopRequested && maxLength <= L; maxLength++) {
+        foundValidProtocol = searchProtocol(helpers, resumed > 0);
+        resumed = 0;
+    }
+    double seconds = elapsedSeconds();
+
+    if (stopRequested) {
+        printf("Stopped at bound %u, the search can be resumed from %s.\n",
+               maxLength - 1, checkpointPath);
+    } else if (!foundValidProtocol) {
+        printf("No protocol with at most %u actions exists.\n", L);
+    }
+    if (checkpointPath && !stopRequested) {
+        // The search is decided, so the checkpoint is of no further use.
+        remove(checkpointPath);
+    }
+    printf("Explored %llu states in %.2f seconds using %u thread(s).\n",
+           (unsigned long long)atomic_load(&totalExploredStates), seconds, numberThreads);
+    return stopRequested ? 128 + SIGTERM : foundValidProtocol ? 10 : 0;
+}
@@ -0,0 +1,20 @@
+#!/bin/bash
+
+# Searches for a protocol with n cards and length l with the native search, see
+# ../05_driver/README.md.
+# Usage: ./runNativeSearch.sh n l [options]...
+
+N=$1
+LENGTH=$2
+NUM_SYM=${NUM_SYM:-'2'} # Two-color decks by default, use NUM_SYM=$N for standard decks
+CHECKPOINT=${CHECKPOINT:-''} # Set CHECKPOINT=file to save the search there and resume it from there
+
+bash ../05_driver/buildDriver.sh || exit
+shift 2
+if [ -n "$CHECKPOINT" ]
+then
+    set -- -k "$CHECKPOINT" nativeSearch.c $N $LENGTH "$@"
+else
+    set -- nativeSearch.c $N $LENGTH "$@"
+fi
+../05_driver/cardDriver run -e native -s $NUM_SYM -o nativeProtocol "$@"
@@ -0,0 +1,34 @@
+#!/bin/bash
+
+# Compiles the driver next to this script unless it is up to date, such that the runners
+# can call it.
+# Usage: ./buildDriver.sh
+
+CC='gcc'
+DIR=`dirname "$0"`
+DRIVER=$DIR"/cardDriver"
+
+UP_TO_DATE=0
+if [ -x $DRIVER ]
+then
+    UP_TO_DATE=1
+    for SOURCE in cardDriver.c jobPool.c runner.c traceDecoder.c resultCache.c unwindBounds.c \
+        gotoCache.c ../shared/protocolRecord.c
+    do
+        if ! [ $DRIVER -nt $DIR"/"$SOURCE ]
+        then
+            UP_TO_DATE=0
+        fi
+    done
+fi
+if [ $UP_TO_DATE -eq 1 ]
+then
+    exit
+fi
+
+if ! [ -x "$(command -v $CC)" ]
+then
+    echo -e $CC" is not a valid compiler. Now terminating."
+    exit 1
+fi
+$CC -O2 -Wall -Wextra $DIR"/cardDriver.c" -o $DRIVER
@@ -0,0 +1,1083 @@
+#include <getopt.h>
+
+#include "jobPool.c"
+#include "runner.c"
+#include "../shared/protocolRecord.c"
+#include "traceDecoder.c"
+#include "resultCache.c"
+#include "unwindBounds.c"
+#include "gotoCache.c"
+
+/**
+ * Driver for the protocol searches. It is called with a subcommand:
+ *
+ *   cubes [-j jobs] [-k depth] [-a actions] [-o prefix] -- command...
+ *       Splits the search of command (a CBMC call on one of the models) into one cube per
+ *       pattern of the first depth actions, passed as '-D ACTION_PREFIX_LENGTH=depth
+ *       -D ACTION_PREFIX=p -D ACTION_PREFIX_BASE=actions'. A model whose number of action
+ *       types differs from actions rejects the cubes. At most jobs cubes run at once, and all
+ *       of them are stopped as soon as one cube finds a protocol.
+ *
+ *   portfolio [-o prefix] [-c options]... -- command...
+ *       Runs command under several solver configurations of CBMC at once and reports the
+ *       first conclusive answer (protocol found or no protocol), stopping the others.
+ *
+ *   sweep [-j jobs] [-m megabytes] [-l first] [-L last] [-o prefix] -- command...
+ *       Runs command for all protocol lengths from first to last at once, where {L} in the
+ *       command is replaced by the length (or '-D L=length' is appended). Lengths without a
+ *       protocol are lower bounds, and once a length yields a protocol, all longer ones are
+ *       cancelled. The result is the minimal protocol length.
+ *
+ *   run [-e cbmc|native] [-d] [-u] [-g] [-s numSym] [-t timeout] [-o prefix | -f file]
+ *       [-b binary] [-c cache] [-C] [-k checkpoint] model n [l] [options]...
+ *       Runs model (one of the symbolic programs, or nativeSearch.c with -e native) for n
+ *       cards and protocol length l like the shell runners did. The constants of the model
+ *       are computed exactly, and the output is written to the terminal and to the file
+ *       prefix_n{n}_l{l}__{host}_{time}.out. Options given as one argument are split at
+ *       spaces, e.g. '-D WEAK_SECURITY=2'. With -d, CBMC prints its trace as JSON, which is
+ *       written to the file with the extension .json and decoded into the output file.
+ *       A found protocol of the native search or of a decoded trace is also written to the
+ *       file with the extension .record (see ../shared/protocolRecord.c).
+ *       Results are stored in the result cache (see resultCache.c), and a configuration
+ *       which is already in the cache is answered from it unless -C is given.
+ *       With -k, the native search saves its progress to the file checkpoint and resumes
+ *       from there if the file exists.
+ *       With -u, the exact bounds of the loops of the model (see unwindBounds.c) are passed
+ *       to CBMC with --unwindset and checked with --unwinding-assertions. A failed unwinding
+ *       assertion ends the run with STATUS_UNWINDING_FAILED instead of a found protocol.
+ *       With -g, CBMC runs on a stored goto binary of the model and its definitions (see
+ *       gotoCache.c), which is compiled first if it is not stored yet.
+ *
+ *   decode [-n cards] [file]
+ *       Decodes the protocol from a trace of CBMC printed with '--json-ui --trace' (read from
+ *       file or the standard input) in a single pass.
+ *
+ *   show record...
+ *       Prints protocol records as JSON.
+ */
+
+/**
+ * Maximal number of configurations of a portfolio.
+ */
+#define MAX_PORTFOLIO 16
+
+/**
+ * Number of processors, used as the default number of parallel jobs.
+ */
+unsigned int numberProcessors() {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (unsigned int)n : 1;
+}
+
+/**
+ * A job is conclusive if it found a protocol.
+ */
+unsigned int foundProtocol(struct jobPool *pool, unsigned int index) {
+    return pool->jobs[index].status == STATUS_PROTOCOL_FOUND;
+}
+
+/**
+ * Writes the actions of cube p with the given number of actions per step, e.g. "TURN SHUFFLE".
+ */
+void printActionPattern(FILE *out, unsigned long long p, unsigned int depth, unsigned int actions) {
+    static const char *names[] = { "TURN", "SHUFFLE", "PROTOCOL" };
+    for (unsigned int i = 0; i < depth; i++, p /= actions) {
+        unsigned int action = p % actions;
+        if (action < 3) {
+            fprintf(out, "%s%s", i ? " " : "", names[action]);
+        } else {
+            fprintf(out, "%s%u", i ? " " : "", action);
+        }
+    }
+}
+
+/**
+ * A job is conclusive if it found a protocol or showed that none exists.
+ */
+unsigned int isVerdict(struct jobPool *pool, unsigned int index) {
+    return pool->jobs[index].status == STATUS_PROTOCOL_FOUND || pool->jobs[index].status == 0;
+}
+
+/**
+ * Returns 1 iff an executable with the given name is on the PATH.
+ */
+unsigned int isOnPath(const char *name) {
+    const char *path = getenv("PATH");
+    while (path && *path) {
+        const char *end = strchr(path, ':');
+        size_t length = end ? (size_t)(end - path) : strlen(path);
+        char candidate[4096];
+        snprintf(candidate, sizeof(candidate), "%.*s/%s", (int)length, path, name);
+        if (length && !access(candidate, X_OK)) {
+            return 1;
+        }
+        path = end ? end + 1 : NULL;
+    }
+    return 0;
+}
+
+/**
+ * Splits options at spaces into at most max arguments, which point into options.
+ */
+unsigned int splitOptions(char *options, char **arguments, unsigned int max) {
+    unsigned int n = 0;
+    for (char *token = strtok(options, " "); token && n < max; token = strtok(NULL, " ")) {
+        arguments[n++] = token;
+    }
+    return n;
+}
+
+/**
+ * Copies argv, where every occurrence of {L} is replaced by the given length.
+ * Returns the number of replacements.
+ */
+unsigned int substituteLength(char **argv, unsigned int length, char **result) {
+    unsigned int replaced = 0;
+    unsigned int n = 0;
+    for (; argv[n]; n++) {
+        char buffer[4096];
+        const char *arg = argv[n];
+        size_t pos = 0;
+        while (*arg && pos + 16 < sizeof(buffer)) {
+            if (!strncmp(arg, "{L}", 3)) {
+                pos += snprintf(buffer + pos, sizeof(buffer) - pos, "%u", length);
+                arg += 3;
+                replaced++;
+            } else {
+                buffer[pos++] = *arg++;
+            }
+        }
+        buffer[pos] = 0;
+        result[n] = strdup(buffer);
+    }
+    result[n] = NULL;
+    return replaced;
+}
+
+/**
+ * A protocol of length l also yields one of length l + 1 (by adding the identity shuffle, or
+ * with SYMMETRY_BREAKING since a run ends at its first final state), so longer lengths are
+ * cancelled once a length has a protocol. Conversely, a length without
+ * a protocol refutes all shorter ones. The sweep is done as soon as the shortest swept length
+ * with a protocol is known and all shorter swept lengths have none.
+ */
+unsigned int isMinimalLength(struct jobPool *pool, unsigned int index) {
+    if (pool->jobs[index].status == STATUS_PROTOCOL_FOUND) {
+        for (unsigned int i = index + 1; i < pool->numberJobs; i++) {
+            cancelJob(pool, i);
+        }
+    }
+    for (unsigned int i = 0; i < pool->numberJobs; i++) {
+        const struct job *job = &pool->jobs[i];
+        if (!job->finished || job->cancelled
+            || (job->status != 0 && job->status != STATUS_PROTOCOL_FOUND)) {
+            return 0;
+        }
+        if (job->status == STATUS_PROTOCOL_FOUND) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void printUsage() {
+    fprintf(stderr,
+            "Usage: cardDriver cubes [-j jobs] [-k depth] [-a actions] [-o prefix] -- command...\n"
+            "       cardDriver portfolio [-o prefix] [-c options]... -- command...\n"
+            "       cardDriver sweep [-j jobs] [-m megabytes] [-l first] [-L last] [-o prefix]"
+            " -- command...\n"
+            "       cardDriver run [-e cbmc|native] [-d] [-u] [-g] [-s numSym] [-t timeout]"
+            " [-o prefix | -f file] [-b binary]\n"
+            "           [-c cache] [-C] [-k checkpoint] model n [l] [options]...\n"
+            "       cardDriver decode [-n cards] [file]\n"
+            "       cardDriver show record...\n");
+}
+
+int runCubes(int argc, char **argv) {
+    unsigned int jobs = numberProcessors();
+    unsigned int depth = 2;
+    unsigned int actions = 2;
+    const char *prefix = "cube";
+    int opt;
+    while ((opt = getopt(argc, argv, "+j:k:a:o:")) != -1) {
+        switch (opt) {
+        case 'j':
+            jobs = (unsigned int)strtoul(optarg, NULL, 10);
+            break;
+        case 'k':
+            depth = (unsigned int)strtoul(optarg, NULL, 10);
+            break;
+        case 'a':
+            actions = (unsigned int)strtoul(optarg, NULL, 10);
+            break;
+        case 'o':
+            prefix = optarg;
+            break;
+        default:
+            printUsage();
+            return 2;
+        }
+    }
+    if (optind >= argc || actions < 1 || depth > 20) {
+        printUsage();
+        return 2;
+    }
+    unsigned long long numberCubes = 1;
+    for (unsigned int i = 0; i < depth; i++) {
+        numberCubes *= actions;
+    }
+
+    struct jobPool pool;
+    initJobPool(&pool, jobs);
+    for (unsigned long long p = 0; p < numberCubes; p++) {
+        char length[64], pattern[64], base[64], outPath[4096];
+        snprintf(length, sizeof(length), "ACTION_PREFIX_LENGTH=%u", depth);
+        snprintf(pattern, sizeof(pattern), "ACTION_PREFIX=%llu", p);
+        snprintf(base, sizeof(base), "ACTION_PREFIX_BASE=%u", actions);
+        snprintf(outPath, sizeof(outPath), "%s_%llu.out", prefix, p);
+        char *extra[] = { "-D", length, "-D", pattern, "-D", base };
+        addJob(&pool, argv + optind, extra, 6, outPath);
+    }
+    printf("Running %llu cubes of depth %u on %u job(s).\n", numberCubes, depth, pool.maxRunning);
+    fflush(stdout);
+
+    int found = runJobPool(&pool, foundProtocol);
+    unsigned int unresolved = 0;
+    for (unsigned int i = 0; i < pool.numberJobs; i++) {
+        const struct job *job = &pool.jobs[i];
+        if ((int)i == found || !job->started || job->status == 0) {
+            continue;
+        }
+        if (found < 0) {
+            fprintf(stderr, "Cube %u (", i);
+            printActionPattern(stderr, i, depth, actions);
+            fprintf(stderr, ") ended with status %d, see %s.\n", job->status, job->outPath);
+        }
+        unresolved++;
+    }
+    int result;
+    if (found >= 0) {
+        printf("Cube %d (", found);
+        printActionPattern(stdout, (unsigned long long)found, depth, actions);
+        printf(") found a protocol after %.1f seconds, see %s.\n",
+               pool.jobs[found].seconds, pool.jobs[found].outPath);
+        result = STATUS_PROTOCOL_FOUND;
+    } else if (poolInterrupted) {
+        printf("The search was interrupted.\n");
+        result = 1;
+    } else if (!unresolved) {
+        printf("No cube contains a protocol.\n");
+        result = 0;
+    } else {
+        printf("%u cube(s) did not finish, the search is inconclusive.\n", unresolved);
+        result = 1;
+    }
+    freeJobPool(&pool);
+    return result;
+}
+
+int runPortfolio(int argc, char **argv) {
+    const char *prefix = "portfolio";
+    // The default MiniSat back end, refinement and CaDiCaL are built into CBMC.
+    char *configurations[MAX_PORTFOLIO] = { "", "--refine", "--sat-solver cadical" };
+    unsigned int numberConfigurations = 3;
+    // External solvers which read DIMACS files, in order of preference.
+    static const char *externalSolvers[] = { "kissat", "cadical", "glucose", "minisat" };
+    for (unsigned int i = 0; i < sizeof(externalSolvers) / sizeof(externalSolvers[0]); i++) {
+        if (isOnPath(externalSolvers[i])) {
+            static char external[64];
+            snprintf(external, sizeof(external), "--external-sat-solver %s", externalSolvers[i]);
+            configurations[numberConfigurations++] = external;
+            break;
+        }
+    }
+    int opt;
+    while ((opt = getopt(argc, argv, "+o:c:")) != -1) {
+        switch (opt) {
+        case 'o':
+            prefix = optarg;
+            break;
+        case 'c':
+            if (numberConfigurations < MAX_PORTFOLIO) {
+                configurations[numberConfigurations++] = optarg;
+            }
+            break;
+        default:
+            printUsage();
+            return 2;
+        }
+    }
+    if (optind >= argc) {
+        printUsage();
+        return 2;
+    }
+
+    struct jobPool pool;
+    initJobPool(&pool, numberConfigurations);
+    for (unsigned int i = 0; i < numberConfigurations; i++) {
+        char options[4096], outPath[4096];
+        char *extra[64];
+        snprintf(options, sizeof(options), "%s", configurations[i]);
+        unsigned int numberExtra = splitOptions(options, extra, 64);
+        snprintf(outPath, sizeof(outPath), "%s_%u.out", prefix, i);
+        addJob(&pool, argv + optind, extra, numberExtra, outPath);
+        printf("Configuration %u: %s\n", i, configurations[i][0] ? configurations[i] : "default");
+    }
+    fflush(stdout);
+
+    int conclusive = runJobPool(&pool, isVerdict);
+    int result = 1;
+    if (conclusive >= 0) {
+        const struct job *job = &pool.jobs[conclusive];
+        printf("Configuration %d answered first after %.1f seconds: %s, see %s.\n", conclusive,
+               job->seconds, job->status ? "protocol found" : "no protocol exists", job->outPath);
+        result = job->status;
+    } else if (poolInterrupted) {
+        printf("The search was interrupted.\n");
+    } else {
+        for (unsigned int i = 0; i < pool.numberJobs; i++) {
+            fprintf(stderr, "Configuration %u ended with status %d, see %s.\n",
+                    i, pool.jobs[i].status, pool.jobs[i].outPath);
+        }
+        printf("No configuration gave a conclusive answer.\n");
+    }
+    freeJobPool(&pool);
+    return result;
+}
+
+int runSweep(int argc, char **argv) {
+    unsigned int jobs = numberProcessors();
+    unsigned long long megabytes = 0;
+    unsigned int first = 1;
+    unsigned int last = 10;
+    const char *prefix = "sweep";
+    int opt;
+    while ((opt = getopt(argc, argv, "+j:m:l:L:o:")) != -1) {
+        switch (opt) {
+        case 'j':
+            jobs = (unsigned int)strtoul(optarg, NULL, 10);
+            break;
+        case 'm':
+            megabytes = strtoull(optarg, NULL, 10);
+            break;
+        case 'l':
+            first = (unsigned int)strtoul(optarg, NULL, 10);
+            break;
+        case 'L':
+            last = (unsigned int)strtoul(optarg, NULL, 10);
+            break;
+        case 'o':
+            prefix = optarg;
+            break;
+        default:
+            printUsage();
+            return 2;
+        }
+    }
+    if (optind >= argc || !first || first > last) {
+        printUsage();
+        return 2;
+    }
+
+    struct jobPool pool;
+    initJobPool(&pool, jobs);
+    unsigned int parallel = pool.maxRunning < last - first + 1 ? pool.maxRunning : last - first + 1;
+    // The memory budget is shared by all jobs which run at the same time.
+    pool.memoryLimit = (megabytes << 20) / parallel;
+    char **args = malloc((argc - optind + 1) * sizeof(char *));
+    for (unsigned int length = first; length <= last; length++) {
+        char value[64], outPath[4096];
+        snprintf(value, sizeof(value), "L=%u", length);
+        snprintf(outPath, sizeof(outPath), "%s_%u.out", prefix, length);
+        char *extra[] = { "-D", value };
+        unsigned int replaced = substituteLength(argv + optind, length, args);
+        addJob(&pool, args, extra, replaced ? 0 : 2, outPath);
+        for (char **arg = args; *arg; arg++) {
+            free(*arg);
+        }
+    }
+    free(args);
+    printf("Sweeping the lengths %u to %u on %u job(s)", first, last, parallel);
+    if (pool.memoryLimit) {
+        printf(" with %llu MB each", pool.memoryLimit >> 20);
+    }
+    printf(".\n");
+    fflush(stdout);
+
+    runJobPool(&pool, isMinimalLength);
+    // Lengths below first are not searched, only a refuted length refutes the shorter ones.
+    unsigned int lowerBound = 0;
+    unsigned int minimal = 0;
+    for (unsigned int i = 0; i < pool.numberJobs; i++) {
+        const struct job *job = &pool.jobs[i];
+        unsigned int length = first + i;
+        if (job->cancelled || !job->started) {
+            continue;
+        }
+        if (job->status == 0) {
+            printf("  L = %u: no protocol (%.1f seconds)\n", length, job->seconds);
+            lowerBound = length;
+        } else if (job->status == STATUS_PROTOCOL_FOUND) {
+            printf("  L = %u: protocol found (%.1f seconds), see %s\n",
+                   length, job->seconds, job->outPath);
+            minimal = minimal ? minimal : length;
+        } else {
+            printf("  L = %u: no answer (status %d), see %s\n", length, job->status, job->outPath);
+        }
+    }
+    int result = 1;
+    if (minimal && lowerBound + 1 == minimal) {
+        printf("The minimal protocol length is %u.\n", minimal);
+        result = STATUS_PROTOCOL_FOUND;
+    } else if (lowerBound == last) {
+        printf("No protocol with at most %u actions exists.\n", last);
+        result = 0;
+    } else {
+        printf("The minimal protocol length is at least %u", lowerBound + 1);
+        if (minimal) {
+            printf(" and at most %u", minimal);
+        }
+        printf(".\n");
+    }
+    freeJobPool(&pool);
+    return result;
+}
+
+/**
+ * Returns 1 iff text is a nonempty decimal number.
+ */
+unsigned int isNumber(const char *text) {
+    return *text && strspn(text, "0123456789") == strlen(text);
+}
+
+void consumeTrace(void *decoder, const char *data, size_t size) {
+    feedTraceDecoder(decoder, data, size);
+}
+
+/**
+ * Returns the options separated by spaces in a new string.
+ */
+char *joinOptions(char *const *options, unsigned int numberOptions) {
+    size_t size = 1;
+    for (unsigned int i = 0; i < numberOptions; i++) {
+        size += strlen(options[i]) + 1;
+    }
+    char *joined = calloc(size, 1);
+    for (unsigned int i = 0; i < numberOptions; i++) {
+        strcat(joined, i ? " " : "");
+        strcat(joined, options[i]);
+    }
+    return joined;
+}
+
+/**
+ * Frees the allocations of runSingle and returns status, such that every exit of a run
+ * releases them. Allocations which were not made yet are NULL.
+ */
+int finishSingle(int status, char **options, unsigned int numberOptions, char **command,
+                 char *unwindText, struct runConstants *constants) {
+    for (unsigned int i = 0; i < numberOptions; i++) {
+        free(options[i]);
+    }
+    free(options);
+    free(command);
+    free(unwindText);
+    free(constants->subgroupSizes);
+    return status;
+}
+
+int runSingle(int argc, char **argv) {
+    unsigned int native = 0;
+    unsigned int decode = 0;
+    unsigned int numSym = 2;
+    const char *timeoutText = "5d";
+    const char *prefix = NULL;
+    const char *outPath = NULL;
+    const char *binary = NULL;
+    const char *cacheFolder = getenv("CARD_RESULT_CACHE");
+    unsigned int useCache = 1;
+    char *checkpoint = NULL;
+    unsigned int unwind = 0;
+    unsigned int useGoto = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "+e:dugs:t:o:f:b:c:Ck:")) != -1) {
+        switch (opt) {
+        case 'e':
+            if (strcmp(optarg, "cbmc") && strcmp(optarg, "native")) {
+                printUsage();
+                return 2;
+            }
+            native = !strcmp(optarg, "native");
+            break;
+        case 'd':
+            decode = 1;
+            break;
+        case 'u':
+            unwind = 1;
+            break;
+        case 'g':
+            useGoto = 1;
+            break;
+        case 's':
+            numSym = (unsigned int)strtoul(optarg, NULL, 10);
+            break;
+        case 't':
+            timeoutText = optarg;
+            break;
+        case 'o':
+            prefix = optarg;
+            break;
+        case 'f':
+            outPath = optarg;
+            break;
+        case 'b':
+            binary = optarg;
+            break;
+        case 'c':
+            cacheFolder = optarg;
+            break;
+        case 'C':
+            useCache = 0;
+            break;
+        case 'k':
+            checkpoint = optarg;
+            break;
+        default:
+            printUsage();
+            return 2;
+        }
+    }
+    if (argc - optind < 2 || !isNumber(argv[optind + 1])) {
+        printUsage();
+        return 2;
+    }
+    const char *model = argv[optind];
+    unsigned int n = (unsigned int)strtoul(argv[optind + 1], NULL, 10);
+    unsigned int length = 0;
+    int first = optind + 2;
+    if (first < argc && isNumber(argv[first])) {
+        length = (unsigned int)strtoul(argv[first++], NULL, 10);
+        if (!length) {
+            printf("No valid protocol length specified. Now terminating.\n");
+            return 2;
+        }
+    }
+    double timeout = parseDuration(timeoutText);
+    if (timeout < 0) {
+        printf("%s is not a valid timeout. Now terminating.\n", timeoutText);
+        return 2;
+    }
+    if (n < 2 || n > MAX_RUN_CARDS) {
+        printf("Program only supports between 2 and %u cards, you entered %u. Now terminating.\n",
+               MAX_RUN_CARDS, n);
+        return 2;
+    }
+    // Decks with more distinct symbols than cards can be represented with fewer symbols.
+    if (numSym < 2 || numSym > n) {
+        printf("Program only supports between two and %u distinct card symbols. You entered the"
+               " value %u. Now terminating.\n", n, numSym);
+        return 2;
+    }
+    if (access(model, R_OK)) {
+        printf("%s is not a valid file. Now terminating.\n", model);
+        return 2;
+    }
+    if (checkpoint && !native) {
+        printf("Checkpoints are only supported by the native search. Now terminating.\n");
+        return 2;
+    }
+    if ((unwind || useGoto) && native) {
+        printf("Unwinding bounds and goto binaries are only supported by CBMC."
+               " Now terminating.\n");
+        return 2;
+    }
+
+    // The options after the length, where quoted groups like '-D MODE=PARAMETER' are split.
+    unsigned int numberOptions = 0;
+    char **options = NULL;
+    for (int i = first; i < argc; i++) {
+        char *copy = strdup(argv[i]);
+        for (char *token = strtok(copy, " "); token; token = strtok(NULL, " ")) {
+            options = realloc(options, (numberOptions + 1) * sizeof(char *));
+            options[numberOptions++] = strdup(token);
+        }
+        free(copy);
+    }
+
+    struct runConstants constants;
+    memset(&constants, 0, sizeof(struct runConstants));
+
+    // The tables and the subgroup catalogue live in shared/ next to the folder of the model.
+    char directory[4096], script[4096], catalogue[4096], defaultCache[4096], gotoFolder[4096];
+    snprintf(directory, sizeof(directory), "%s", model);
+    char *slash = strrchr(directory, '/');
+    if (slash) {
+        *slash = 0;
+    } else {
+        snprintf(directory, sizeof(directory), ".");
+    }
+    const char *gotoCache = getenv("CARD_GOTO_CACHE");
+    if (   snprintf(script, sizeof(script), "%s/../shared/generateTables.sh", directory)
+           >= (int)sizeof(script)
+        || snprintf(catalogue, sizeof(catalogue), "%s/../shared/generated/subgroups_N%u.bin",
+                    directory, n) >= (int)sizeof(catalogue)
+        || snprintf(defaultCache, sizeof(defaultCache), "%s/../shared/results", directory)
+           >= (int)sizeof(defaultCache)
+        || (gotoCache ? snprintf(gotoFolder, sizeof(gotoFolder), "%s", gotoCache)
+                 : snprintf(gotoFolder, sizeof(gotoFolder), "%s/../shared/goto", directory))
+           >= (int)sizeof(gotoFolder)) {
+        printf("The path of %s is too long. Now terminating.\n", model);
+        return finishSingle(2, options, numberOptions, NULL, NULL, &constants);
+    }
+    if (!cacheFolder) {
+        cacheFolder = defaultCache;
+    }
+    char nText[16], numSymText[16];
+    snprintf(nText, sizeof(nText), "%u", n);
+    snprintf(numSymText, sizeof(numSymText), "%u", numSym);
+    if (!access(script, R_OK)) {
+        char *generate[] = { "bash", script, nText, numSymText, NULL };
+        runCommand(generate);
+    }
+    computeRunConstants(n, numSym, catalogue, &constants);
+
+    char start[128], startName[128], host[256];
+    formatStartTime(start, sizeof(start), startName, sizeof(startName));
+    if (gethostname(host, sizeof(host))) {
+        snprintf(host, sizeof(host), "unknown");
+    }
+    host[sizeof(host) - 1] = 0;
+
+    char version[512], line[4096];
+    char nativeBinary[4096] = "";
+    const char *compiler = getenv("CC") ? getenv("CC") : "gcc";
+    if (native) {
+        if (!isOnPath(compiler)) {
+            printf("%s is not a valid compiler. Now terminating.\n", compiler);
+            return finishSingle(2, options, numberOptions, NULL, NULL, &constants);
+        }
+        snprintf(line, sizeof(line), "%s --version 2>&1", compiler);
+        readFirstLine(line, version, sizeof(version));
+    } else {
+        // A CBMC binary in the current folder takes precedence, as for the shell runners.
+        if (!binary) {
+            binary = access("./cbmc", X_OK) ? "cbmc" : "./cbmc";
+        }
+        if (access(binary, X_OK) && !isOnPath(binary)) {
+            printf("%s is not a valid cbmc binary. Now terminating.\n", binary);
+            return finishSingle(2, options, numberOptions, NULL, NULL, &constants);
+        }
+        snprintf(line, sizeof(line), "%s -version 2>&1", binary);
+        readFirstLine(line, version, sizeof(version));
+    }
+
+    // The constants every model expects, followed by the subgroup orders for CBMC.
+    char defines[64][64];
+    unsigned int numberDefines = 0;
+    if (length) {
+        snprintf(defines[numberDefines++], 64, "L=%u", length);
+    }
+    snprintf(defines[numberDefines++], 64, "N=%u", n);
+    snprintf(defines[numberDefines++], 64, "NUM_SYM=%u", numSym);
+    snprintf(defines[numberDefines++], 64, "NUMBER_POSSIBLE_SEQUENCES=%llu",
+             constants.possibleSequences);
+    snprintf(defines[numberDefines++], 64, "NUMBER_POSSIBLE_PERMUTATIONS=%llu",
+             constants.possiblePermutations);
+    if (!native && constants.permSetSize) {
+        snprintf(defines[numberDefines++], 64, "PERM_SET_SIZE=%llu", constants.permSetSize);
+    }
+    if (!native && constants.subgroupSizesKnown) {
+        unsigned int fits = constants.numberSubgroupSizes <= MAX_SUBGROUP_SIZES;
+        snprintf(defines[numberDefines++], 64, "NUMBER_SUBGROUP_SIZES=%u",
+                 fits ? constants.numberSubgroupSizes : 0);
+        for (unsigned int i = 0; fits && i < constants.numberSubgroupSizes; i++) {
+            snprintf(defines[numberDefines++], 64, "SUBGROUP_SIZE_%u=%u",
+                     i + 1, constants.subgroupSizes[i]);
+        }
+    }
+
+    // All definitions, of the constants and among the options, are compiled into the binary.
+    char gotoBinary[4096] = "";
+    if (useGoto) {
+        char **definitions = malloc((2 * numberDefines + numberOptions + 1) * sizeof(char *));
+        unsigned int numberDefinitions = 0;
+        for (unsigned int i = 0; i < numberDefines; i++) {
+            definitions[numberDefinitions++] = "-D";
+            definitions[numberDefinitions++] = defines[i];
+        }
+        for (unsigned int i = 0; i < numberOptions; i++) {
+            if (!strcmp(options[i], "-D") && i + 1 < numberOptions) {
+                definitions[numberDefinitions++] = options[i++];
+                definitions[numberDefinitions++] = options[i];
+            } else if (!strncmp(options[i], "-D", 2)) {
+                definitions[numberDefinitions++] = options[i];
+            }
+        }
+        unsigned int prepared = prepareGotoBinary(gotoFolder, model, binary, definitions,
+                                                  numberDefinitions, gotoBinary,
+                                                  sizeof(gotoBinary));
+        free(definitions);
+        if (!prepared) {
+            printf("Cannot prepare the goto binary of %s. Now terminating.\n", model);
+            return finishSingle(2, options, numberOptions, NULL, NULL, &constants);
+        }
+    }
+
+    // The loops are listed and their bounds evaluated under the same definitions as the run.
+    struct unwindSet unwindSet;
+    memset(&unwindSet, 0, sizeof(struct unwindSet));
+    if (unwind) {
+        char **showLoops = malloc((2 * numberDefines + numberOptions + 4) * sizeof(char *));
+        char **preprocess = malloc((2 * numberDefines + numberOptions + 6) * sizeof(char *));
+        unsigned int numberShowLoops = 0, numberPreprocess = 0;
+        showLoops[numberShowLoops++] = (char *)binary;
+        showLoops[numberShowLoops++] = "--show-loops";
+        preprocess[numberPreprocess++] = (char *)compiler;
+        preprocess[numberPreprocess++] = "-E";
+        preprocess[numberPreprocess++] = "-dM";
+        for (unsigned int i = 0; i < numberDefines; i++) {
+            showLoops[numberShowLoops++] = preprocess[numberPreprocess++] = "-D";
+            showLoops[numberShowLoops++] = preprocess[numberPreprocess++] = defines[i];
+        }
+        showLoops[numberShowLoops++] = preprocess[numberPreprocess++] = (char *)model;
+        for (unsigned int i = 0; i < numberOptions; i++) {
+            showLoops[numberShowLoops++] = options[i];
+            if (!strncmp(options[i], "-D", 2)) {
+                preprocess[numberPreprocess++] = options[i];
+                if (!strcmp(options[i], "-D") && i + 1 < numberOptions) {
+                    preprocess[numberPreprocess++] = options[i + 1];
+                }
+            }
+        }
+        showLoops[numberShowLoops] = preprocess[numberPreprocess] = NULL;
+        // The loops of a goto binary are numbered after its simplifications.
+        if (useGoto) {
+            showLoops[2] = gotoBinary;
+            showLoops[3] = NULL;
+        }
+        unsigned int derived = isOnPath(compiler)
+                               && deriveUnwindSet(showLoops, preprocess, compiler, directory,
+                                                  &unwindSet);
+        free(showLoops);
+        free(preprocess);
+        if (!derived) {
+            printf("Cannot derive the unwinding bounds of %s. Now terminating.\n", model);
+            return finishSingle(2, options, numberOptions, NULL, unwindSet.text, &constants);
+        }
+    }
+
+    char **command = malloc((2 * numberDefines + numberOptions + 11) * sizeof(char *));
+    unsigned int numberArguments = 0;
+    if (native) {
+        snprintf(nativeBinary, sizeof(nativeBinary), "./nativeSearch_n%u_s%u_l%u_%s",
+                 n, numSym, length, startName);
+        command[numberArguments++] = (char *)compiler;
+        command[numberArguments++] = "-O2";
+        command[numberArguments++] = "-pthread";
+    } else if (decode) {
+        command[numberArguments++] = (char *)binary;
+        command[numberArguments++] = "--json-ui";
+        command[numberArguments++] = "--trace";
+    } else {
+        command[numberArguments++] = (char *)binary;
+        command[numberArguments++] = "--compact-trace";
+        command[numberArguments++] = "--trace-hex";
+    }
+    if (unwind && unwindSet.numberBounded) {
+        command[numberArguments++] = "--unwindset";
+        command[numberArguments++] = unwindSet.text;
+        command[numberArguments++] = "--unwinding-assertions";
+    }
+    for (unsigned int i = 0; i < numberDefines; i++) {
+        command[numberArguments++] = "-D";
+        command[numberArguments++] = defines[i];
+    }
+    command[numberArguments++] = (char *)model;
+    for (unsigned int i = 0; i < numberOptions; i++) {
+        command[numberArguments++] = options[i];
+    }
+
+    // The key covers everything but the binary, the model path and the name of the binary
+    // of the native search, which changes with every run.
+    char **keyArguments = malloc(numberArguments * sizeof(char *));
+    unsigned int numberKeyArguments = 0;
+    for (unsigned int i = 1; i < numberArguments; i++) {
+        if (command[i] != model) {
+            keyArguments[numberKeyArguments++] = command[i];
+        }
+    }
+    struct cacheKey key;
+    unsigned int listed = computeCacheKey(&key, compiler, model, native ? "native" : "cbmc",
+                                          version, keyArguments, numberKeyArguments);
+    free(keyArguments);
+    if (!listed) {
+        printf("Cannot list the files included by %s. Now terminating.\n", model);
+        return finishSingle(2, options, numberOptions, command, unwindSet.text, &constants);
+    }
+    struct cachedResult cached;
+    // A search with a checkpoint continues from it instead of repeating a stored timeout.
+    unsigned int fromCache = useCache && readCachedResult(cacheFolder, &key, &cached, NULL)
+                             && answersRun(&cached, checkpoint ? 0 : timeout);
+
+    if (native) {
+        command[numberArguments++] = "-o";
+        command[numberArguments++] = nativeBinary;
+    }
+    // The key is the one of the source, but the binary replaces the model and definitions.
+    if (useGoto) {
+        unsigned int kept = 0;
+        for (unsigned int i = 0; i < numberArguments; i++) {
+            if (!strcmp(command[i], "-D")) {
+                i++;
+            } else if (command[i] == model) {
+                command[kept++] = gotoBinary;
+            } else if (strncmp(command[i], "-D", 2)) {
+                command[kept++] = command[i];
+            }
+        }
+        numberArguments = kept;
+    }
+    command[numberArguments] = NULL;
+    if (native && !fromCache && runCommand(command)) {
+        printf("Compiling %s failed. Now terminating.\n", model);
+        return finishSingle(2, options, numberOptions, command, unwindSet.text, &constants);
+    }
+
+    char defaultPath[4096];
+    if (!outPath) {
+        char name[4096];
+        if (prefix) {
+            snprintf(name, sizeof(name), "%s", prefix);
+        } else {
+            const char *base = strrchr(model, '/');
+            snprintf(name, sizeof(name), "%s", base ? base + 1 : model);
+            char *dot = strrchr(name, '.');
+            if (dot) {
+                *dot = 0;
+            }
+        }
+        int written;
+        if (length) {
+            written = snprintf(defaultPath, sizeof(defaultPath), "%s_n%u_l%u__%s_%s.out",
+                               name, n, length, host, startName);
+        } else {
+            written = snprintf(defaultPath, sizeof(defaultPath), "%s_n%u__%s_%s.out",
+                               name, n, host, startName);
+        }
+        if (written >= (int)sizeof(defaultPath)) {
+            printf("The output path of %s is too long. Now terminating.\n", name);
+            return finishSingle(2, options, numberOptions, command, unwindSet.text, &constants);
+        }
+        outPath = defaultPath;
+    }
+    FILE *out = fopen(outPath, "w");
+    if (!out) {
+        printf("Cannot write %s. Now terminating.\n", outPath);
+        return finishSingle(2, options, numberOptions, command, unwindSet.text, &constants);
+    }
+
+    printTeed(out, "\n############################################################\n");
+    printTeed(out, "# HOST: %s\n# Timestamp: %s\n", host, start);
+    printTeed(out, "# %s: %s\n", native ? "Compiler" : "CBMC Version", version);
+    if (numberOptions) {
+        printTeed(out, "# Further Options: ");
+        printOptions(stdout, options, numberOptions);
+        printOptions(out, options, numberOptions);
+        printTeed(out, "\n");
+    }
+    printTeed(out, "# N = %u, NUM_SYM = %u, ", n, numSym);
+    if (length) {
+        printTeed(out, "L = %u, ", length);
+    }
+    printTeed(out, "NUMBER_POSSIBLE_PERMUTATIONS = %llu, NUMBER_POSSIBLE_SEQUENCES = %llu,"
+              " TIMEOUT = %s\n", constants.possiblePermutations, constants.possibleSequences,
+              timeoutText);
+    if (unwind) {
+        printTeed(out, "# Unwinding bounds of %u of %u loops: %s\n", unwindSet.numberBounded,
+                  unwindSet.numberLoops, unwindSet.text);
+    }
+    printTeed(out, "############################################################\n");
+    printTeed(out, "\n############################################################\n\n");
+
+    char tracePath[4096], recordPath[4096];
+    size_t stem = strlen(outPath);
+    stem -= (stem >= 4 && !strcmp(outPath + stem - 4, ".out")) ? 4 : 0;
+    snprintf(tracePath, sizeof(tracePath), "%.*s.json", (int)stem, outPath);
+    snprintf(recordPath, sizeof(recordPath), "%.*s.record", (int)stem, outPath);
+    struct protocolRecord record;
+    initProtocolRecord(&record);
+
+    struct timespec begin;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    long bodyBegin = ftell(out);
+    int status;
+    if (fromCache) {
+        printTeed(out, "# Answered from the result cache (key %s), computed on %s at %s in"
+                  " %.0f seconds.\n", key.text, cached.host, cached.timestamp, cached.seconds);
+        readCachedResult(cacheFolder, &key, &cached, out);
+        status = cached.status;
+    } else if (native) {
+        remove(recordPath);
+        char *search[] = { nativeBinary, "-r", recordPath, "-c", checkpoint, "--resume", NULL };
+        if (!checkpoint) {
+            search[3] = NULL;
+        }
+        status = runTeed(search, out, timeout, NULL, NULL);
+        unlink(nativeBinary);
+        readProtocolRecord(recordPath, &record);
+    } else if (decode) {
+        // The trace only goes to its own file, the decoded protocol to the output file.
+        FILE *trace = fopen(tracePath, "w");
+        if (!trace) {
+            printf("Cannot write %s. Now terminating.\n", tracePath);
+            fclose(out);
+            freeProtocolRecord(&record);
+            return finishSingle(2, options, numberOptions, command, unwindSet.text, &constants);
+        }
+        struct traceDecoder *decoder = malloc(sizeof(struct traceDecoder));
+        initTraceDecoder(decoder, n, out);
+        decoder->record = &record;
+        status = runTeed(command, trace, timeout, consumeTrace, decoder);
+        finishTraceDecoder(decoder);
+        printTeed(out, "# The trace is in %s.\n", tracePath);
+        free(decoder);
+        fclose(trace);
+    } else {
+        status = runTeed(command, out, timeout, NULL, NULL);
+    }
+    // A failed unwinding assertion ends CBMC with the status of a found protocol.
+    if (!fromCache && unwind && unwindSet.numberBounded && status == STATUS_PROTOCOL_FOUND) {
+        fflush(out);
+        if (hasFailedUnwinding(decode ? tracePath : outPath)) {
+            printTeed(out, "# An unwinding assertion failed, the derived bounds are too small."
+                      " The result is not stored.\n");
+            status = STATUS_UNWINDING_FAILED;
+        }
+    }
+    double seconds = secondsSince(&begin);
+    long bodyEnd = ftell(out);
+
+    char end[128], endName[128];
+    formatStartTime(end, sizeof(end), endName, sizeof(endName));
+    printTeed(out, "\n############################################################\n");
+    printTeed(out, "# Final Time: %s\n# It took %.0f seconds.\n", end, seconds);
+    if (status == STATUS_TIMEOUT) {
+        printTeed(out, "# The timeout of %s was reached.\n", timeoutText);
+    }
+    printTeed(out, "############################################################\n");
+    fclose(out);
+
+    if (record.length && status != STATUS_UNWINDING_FAILED) {
+        record.n = n;
+        record.numSym = numSym;
+        if (length) {
+            record.maxLength = length;
+        } else if (!record.maxLength) {
+            record.maxLength = record.length;
+        }
+        record.seconds = seconds;
+        free(record.options);
+        record.options = joinOptions(options, numberOptions);
+        if (writeProtocolRecord(recordPath, &record)) {
+            printf("# The protocol record is in %s.\n", recordPath);
+        }
+    }
+    freeProtocolRecord(&record);
+
+    if (fromCache) {
+        if (restoreCachedRecord(cacheFolder, &key, recordPath)) {
+            printf("# The protocol record is in %s.\n", recordPath);
+        }
+    } else if (status != STATUS_UNWINDING_FAILED) {
+        struct cachedResult result;
+        memset(&result, 0, sizeof(struct cachedResult));
+        result.status = status;
+        result.seconds = seconds;
+        snprintf(result.host, sizeof(result.host), "%s", host);
+        snprintf(result.timestamp, sizeof(result.timestamp), "%s", start);
+        storeCachedResult(cacheFolder, &key, &result, outPath, bodyBegin, bodyEnd, recordPath);
+    }
+
+    return finishSingle(status, options, numberOptions, command, unwindSet.text, &constants);
+}
+
+int runDecode(int argc, char **argv) {
+    unsigned int n = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "+n:")) != -1) {
+        switch (opt) {
+        case 'n':
+            n = (unsigned int)strtoul(optarg, NULL, 10);
+            break;
+        default:
+            printUsage();
+            return 2;
+        }
+    }
+    FILE *in = stdin;
+    if (optind < argc && !(in = fopen(argv[optind], "r"))) {
+        fprintf(stderr, "Cannot read %s.\n", argv[optind]);
+        return 2;
+    }
+    struct traceDecoder *decoder = malloc(sizeof(struct traceDecoder));
+    initTraceDecoder(decoder, n, NULL);
+    char buffer[65536];
+    size_t size;
+    while ((size = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        feedTraceDecoder(decoder, buffer, size);
+    }
+    unsigned int traces = finishTraceDecoder(decoder);
+    free(decoder);
+    if (in != stdin) {
+        fclose(in);
+    }
+    return traces ? 0 : 1;
+}
+
+int runShow(int argc, char **argv) {
+    if (argc < 2) {
+        printUsage();
+        return 2;
+    }
+    int result = 0;
+    for (int i = 1; i < argc; i++) {
+        struct protocolRecord record;
+        if (!readProtocolRecord(argv[i], &record)) {
+            fprintf(stderr, "Cannot read the protocol record %s.\n", argv[i]);
+            result = 1;
+            continue;
+        }
+        printProtocolRecordJson(stdout, &record);
+        freeProtocolRecord(&record);
+    }
+    return result;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        printUsage();
+        return 2;
+    }
+    installInterruptHandler();
+    // The subcommand takes the place of the program name for getopt.
+    if (!strcmp(argv[1], "cubes")) {
+        return runCubes(argc - 1, argv + 1);
+    }
+    if (!strcmp(argv[1], "portfolio")) {
+        return runPortfolio(argc - 1, argv + 1);
+    }
+    if (!strcmp(argv[1], "sweep")) {
+        return runSweep(argc - 1, argv + 1);
+    }
+    if (!strcmp(argv[1], "run")) {
+        return runSingle(argc - 1, argv + 1);
+    }
+    if (!strcmp(argv[1], "decode")) {
+        return runDecode(argc - 1, argv + 1);
+    }
+    if (!strcmp(argv[1], "show")) {
+        return runShow(argc - 1, argv + 1);
+    }
+    printUsage();
+    return 2;
+}
@@ -0,0 +1,116 @@
+/**
+ * Local store of the goto binaries of the models, such that the front end of CBMC (parsing
+ * and type checking the model with all files it includes) runs once per model and set of
+ * definitions instead of once per run. A binary is compiled with goto-cc, simplified with
+ * goto-instrument and stored as key.gb, where the key is a hash of the model source (with
+ * all files it includes, see computeCacheKey), the version of goto-cc, the definitions and
+ * the simplifications. A binary compiled before the tables were generated, or against tables
+ * which were regenerated since, is therefore not reused.
+ */
+
+/**
+ * The simplifications applied by goto-instrument: constants (like the tables and all
+ * sizes) are propagated, and everything the result of the run does not depend on is
+ * sliced away.
+ */
+static char *const gotoInstrumentOptions[] = { "--constant-propagator", "--full-slice" };
+
+#define NUMBER_GOTO_INSTRUMENT_OPTIONS \
+    (sizeof(gotoInstrumentOptions) / sizeof(gotoInstrumentOptions[0]))
+
+/**
+ * Writes the path of the tool of CBMC (e.g. goto-cc) into path: the one next to the CBMC
+ * binary if that is given with a folder and the tool exists there, otherwise its name.
+ */
+void findCbmcTool(const char *cbmc, const char *tool, char *path, size_t size) {
+    const char *slash = strrchr(cbmc, '/');
+    if (slash) {
+        snprintf(path, size, "%.*s/%s", (int)(slash - cbmc), cbmc, tool);
+        if (!access(path, X_OK)) {
+            return;
+        }
+    }
+    snprintf(path, size, "%s", tool);
+}
+
+/**
+ * Writes the path of the goto binary of model with the given definitions (each one
+ * following a "-D" in the list) from folder into path, and compiles it first if it is not
+ * stored yet. Returns 1 if the binary exists afterwards.
+ */
+unsigned int prepareGotoBinary(const char *folder, const char *model, const char *cbmc,
+                               char *const *definitions, unsigned int numberDefinitions,
+                               char *path, size_t size) {
+    char compiler[4096], instrument[4096], command[4096], version[512];
+    findCbmcTool(cbmc, "goto-cc", compiler, sizeof(compiler));
+    findCbmcTool(cbmc, "goto-instrument", instrument, sizeof(instrument));
+    if (snprintf(command, sizeof(command), "%s --version 2>&1", compiler)
+        >= (int)sizeof(command)) {
+        fprintf(stderr, "The path of %s is too long.\n", compiler);
+        return 0;
+    }
+    readFirstLine(command, version, sizeof(version));
+
+    char **arguments = malloc((numberDefinitions + NUMBER_GOTO_INSTRUMENT_OPTIONS + 1)
+                              * sizeof(char *));
+    unsigned int numberArguments = 0;
+    for (unsigned int i = 0; i < numberDefinitions; i++) {
+        arguments[numberArguments++] = definitions[i];
+    }
+    for (unsigned int i = 0; i < NUMBER_GOTO_INSTRUMENT_OPTIONS; i++) {
+        arguments[numberArguments++] = gotoInstrumentOptions[i];
+    }
+    // The preprocessor of goto-cc is the one of the C compiler.
+    const char *preprocessor = getenv("CC") ? getenv("CC") : "gcc";
+    struct cacheKey key;
+    unsigned int listed = computeCacheKey(&key, preprocessor, model, "goto-cc", version,
+                                          arguments, numberArguments);
+    free(arguments);
+    if (!listed) {
+        fprintf(stderr, "Cannot list the files included by %s.\n", model);
+        return 0;
+    }
+    snprintf(path, size, "%s/%s.gb", folder, key.text);
+    if (!access(path, R_OK)) {
+        return 1;
+    }
+    if (!makeFolders(folder)) {
+        fprintf(stderr, "Cannot create the goto binary cache %s.\n", folder);
+        return 0;
+    }
+
+    // Both steps write temporary files, such that parallel runs never see a partial binary.
+    char compiled[4096], simplified[4096];
+    snprintf(compiled, sizeof(compiled), "%s.%ld.cc.tmp", path, (long)getpid());
+    snprintf(simplified, sizeof(simplified), "%s.%ld.tmp", path, (long)getpid());
+    char **compile = malloc((numberDefinitions + 5) * sizeof(char *));
+    unsigned int numberCompile = 0;
+    compile[numberCompile++] = compiler;
+    for (unsigned int i = 0; i < numberDefinitions; i++) {
+        compile[numberCompile++] = definitions[i];
+    }
+    compile[numberCompile++] = (char *)model;
+    compile[numberCompile++] = "-o";
+    compile[numberCompile++] = compiled;
+    compile[numberCompile] = NULL;
+    char *simplify[NUMBER_GOTO_INSTRUMENT_OPTIONS + 4];
+    unsigned int numberSimplify = 0;
+    simplify[numberSimplify++] = instrument;
+    for (unsigned int i = 0; i < NUMBER_GOTO_INSTRUMENT_OPTIONS; i++) {
+        simplify[numberSimplify++] = gotoInstrumentOptions[i];
+    }
+    simplify[numberSimplify++] = compiled;
+    simplify[numberSimplify++] = simplified;
+    simplify[numberSimplify] = NULL;
+
+    printf("# Compiling the goto binary %s.\n", path);
+    unsigned int prepared = !runCommand(compile) && !runCommand(simplify)
+                            && !rename(simplified, path);
+    free(compile);
+    remove(compiled);
+    remove(simplified);
+    if (!prepared) {
+        fprintf(stderr, "Cannot compile the goto binary of %s.\n", model);
+    }
+    return prepared;
+}
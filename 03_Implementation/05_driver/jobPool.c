@@ -0,0 +1,281 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * Local process pool for the driver. Every job is a command line whose output is written to
+ * its own file. At most maxRunning jobs run at the same time, and the whole pool is stopped
+ * as soon as one job gives a conclusive answer.
+ */
+
+/**
+ * Exit status of CBMC (and of the native search) if a protocol was found.
+ */
+#define STATUS_PROTOCOL_FOUND 10
+
+/**
+ * Seconds between SIGTERM and SIGKILL when jobs are stopped.
+ */
+#define KILL_GRACE_SECONDS 2
+
+struct job {
+    char **argv;
+    char *outPath;
+    pid_t pid;
+    unsigned int started;
+    unsigned int finished;
+    unsigned int cancelled;
+    /**
+     * Exit status of the job, or 128 + signal number if it was terminated by a signal.
+     */
+    int status;
+    double seconds;
+    struct timespec begin;
+};
+
+struct jobPool {
+    struct job *jobs;
+    unsigned int numberJobs;
+    unsigned int capacity;
+    unsigned int maxRunning;
+    /**
+     * Address space limit of every job in bytes, 0 for no limit.
+     */
+    unsigned long long memoryLimit;
+};
+
+/**
+ * Set by SIGINT or SIGTERM, upon which the running pool stops all its jobs.
+ */
+volatile sig_atomic_t poolInterrupted;
+
+void interruptPool(int signal) {
+    (void)signal;
+    poolInterrupted = 1;
+}
+
+/**
+ * The jobs run in their own process groups and do not see a Ctrl-C in the terminal,
+ * so the driver forwards it by stopping the pool.
+ */
+void installInterruptHandler() {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = interruptPool;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+}
+
+void initJobPool(struct jobPool *pool, unsigned int maxRunning) {
+    pool->jobs = NULL;
+    pool->numberJobs = 0;
+    pool->capacity = 0;
+    pool->maxRunning = maxRunning ? maxRunning : 1;
+    pool->memoryLimit = 0;
+}
+
+/**
+ * Copies a NULL-terminated argument vector, appending the given extra arguments.
+ */
+char **copyArguments(char *const *argv, char *const *extra, unsigned int numberExtra) {
+    unsigned int n = 0;
+    while (argv[n]) {
+        n++;
+    }
+    char **copy = malloc((n + numberExtra + 1) * sizeof(char *));
+    for (unsigned int i = 0; i < n; i++) {
+        copy[i] = strdup(argv[i]);
+    }
+    for (unsigned int i = 0; i < numberExtra; i++) {
+        copy[n + i] = strdup(extra[i]);
+    }
+    copy[n + numberExtra] = NULL;
+    return copy;
+}
+
+/**
+ * Adds a job which runs argv (extended by the extra arguments) with its output in outPath.
+ * Returns the index of the job.
+ */
+unsigned int addJob(struct jobPool *pool, char *const *argv, char *const *extra,
+                    unsigned int numberExtra, const char *outPath) {
+    if (pool->numberJobs == pool->capacity) {
+        pool->capacity = pool->capacity ? 2 * pool->capacity : 16;
+        pool->jobs = realloc(pool->jobs, pool->capacity * sizeof(struct job));
+    }
+    struct job *job = &pool->jobs[pool->numberJobs];
+    memset(job, 0, sizeof(struct job));
+    job->argv = copyArguments(argv, extra, numberExtra);
+    job->outPath = strdup(outPath);
+    job->status = -1;
+    return pool->numberJobs++;
+}
+
+void freeJobPool(struct jobPool *pool) {
+    for (unsigned int i = 0; i < pool->numberJobs; i++) {
+        for (char **arg = pool->jobs[i].argv; *arg; arg++) {
+            free(*arg);
+        }
+        free(pool->jobs[i].argv);
+        free(pool->jobs[i].outPath);
+    }
+    free(pool->jobs);
+    pool->jobs = NULL;
+    pool->numberJobs = pool->capacity = 0;
+}
+
+double secondsSince(const struct timespec *begin) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - begin->tv_sec) + (now.tv_nsec - begin->tv_nsec) / 1e9;
+}
+
+/**
+ * Starts the job in its own process group, such that it can be stopped together with
+ * all processes it spawns (e.g., the solver below CBMC).
+ */
+void startJob(struct job *job, unsigned long long memoryLimit) {
+    clock_gettime(CLOCK_MONOTONIC, &job->begin);
+    job->started = 1;
+    pid_t pid = fork();
+    if (pid == 0) {
+        setpgid(0, 0);
+        if (memoryLimit) {
+            struct rlimit limit = { memoryLimit, memoryLimit };
+            setrlimit(RLIMIT_AS, &limit);
+        }
+        int out = open(job->outPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out >= 0) {
+            dup2(out, STDOUT_FILENO);
+            dup2(out, STDERR_FILENO);
+            close(out);
+        }
+        execvp(job->argv[0], job->argv);
+        fprintf(stderr, "Cannot execute %s: %s\n", job->argv[0], strerror(errno));
+        _exit(127);
+    }
+    if (pid < 0) {
+        fprintf(stderr, "Cannot fork: %s\n", strerror(errno));
+        job->finished = 1;
+        job->status = 127;
+        return;
+    }
+    setpgid(pid, pid);
+    job->pid = pid;
+}
+
+/**
+ * Stops all running jobs of the pool, first politely, then by force.
+ */
+void stopJobs(struct jobPool *pool) {
+    unsigned int running = 0;
+    for (unsigned int i = 0; i < pool->numberJobs; i++) {
+        if (pool->jobs[i].started && !pool->jobs[i].finished) {
+            killpg(pool->jobs[i].pid, SIGTERM);
+            running = 1;
+        }
+    }
+    for (unsigned int t = 0; running && t < 10 * KILL_GRACE_SECONDS; t++) {
+        running = 0;
+        for (unsigned int i = 0; i < pool->numberJobs; i++) {
+            struct job *job = &pool->jobs[i];
+            if (job->started && !job->finished) {
+                int status;
+                if (waitpid(job->pid, &status, WNOHANG) == job->pid) {
+                    job->finished = 1;
+                    job->status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+                    job->seconds = secondsSince(&job->begin);
+                } else {
+                    running = 1;
+                }
+            }
+        }
+        if (running) {
+            usleep(100000);
+        }
+    }
+    for (unsigned int i = 0; i < pool->numberJobs; i++) {
+        struct job *job = &pool->jobs[i];
+        if (job->started && !job->finished) {
+            killpg(job->pid, SIGKILL);
+            waitpid(job->pid, NULL, 0);
+            job->finished = 1;
+            job->status = 128 + SIGKILL;
+            job->seconds = secondsSince(&job->begin);
+        }
+    }
+}
+
+/**
+ * Cancels a single job: it is killed if it is running and never started otherwise.
+ * The killed job is collected by runJobPool.
+ */
+void cancelJob(struct jobPool *pool, unsigned int index) {
+    struct job *job = &pool->jobs[index];
+    if (job->finished || job->cancelled) {
+        return;
+    }
+    job->cancelled = 1;
+    if (job->started) {
+        killpg(job->pid, SIGKILL);
+    }
+}
+
+/**
+ * Runs all jobs of the pool in the order they were added. After every finished job which
+ * was not cancelled, isConclusive decides whether the pool is stopped, in which case all
+ * remaining jobs are killed or never started. It may also cancel single jobs.
+ * Returns the index of the conclusive job, or -1 if there is none.
+ */
+int runJobPool(struct jobPool *pool,
+               unsigned int (*isConclusive)(struct jobPool *pool, unsigned int index)) {
+    unsigned int next = 0;
+    unsigned int running = 0;
+    while (next < pool->numberJobs || running) {
+        while (next < pool->numberJobs && running < pool->maxRunning) {
+            struct job *job = &pool->jobs[next++];
+            if (!job->cancelled) {
+                startJob(job, pool->memoryLimit);
+                running += !job->finished;
+            }
+        }
+        if (!running) {
+            continue;
+        }
+        int status;
+        pid_t pid = wait(&status);
+        if (poolInterrupted) {
+            stopJobs(pool);
+            return -1;
+        }
+        if (pid < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (unsigned int i = 0; i < next; i++) {
+            struct job *job = &pool->jobs[i];
+            if (job->started && !job->finished && job->pid == pid) {
+                job->finished = 1;
+                job->status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+                job->seconds = secondsSince(&job->begin);
+                running--;
+                if (!job->cancelled && isConclusive(pool, i)) {
+                    stopJobs(pool);
+                    return (int)i;
+                }
+            }
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,22 @@
+#!/bin/bash
+
+# Prints the number of variables and clauses of the formula CBMC builds for a model, without
+# solving it, such that two versions of a model can be compared.
+# Usage: ./measureFormula.sh [run options] model n l [options]...
+# e.g.:  ./measureFormula.sh -s 2 ../01_boolean_operators/findTwoCardProtocolAND.c 4 6
+
+DIR=`dirname "$0"`
+bash $DIR"/buildDriver.sh" || exit
+
+# The run goes to a temporary result cache, such that the formula is never taken for a verdict.
+TEMP=`mktemp -d`
+$DIR"/cardDriver" run -c $TEMP"/results" -f $TEMP"/run.out" "$@" --dimacs --outfile $TEMP"/formula.cnf" > /dev/null
+if ! grep -q "^p cnf" $TEMP"/formula.cnf" 2> /dev/null
+then
+    echo -e "CBMC did not write a formula, see the output below. Now terminating."
+    cat $TEMP"/run.out"
+    rm -rf $TEMP
+    exit 1
+fi
+grep -m 1 "^p cnf" $TEMP"/formula.cnf" | awk '{ print "Variables: "$3", clauses: "$4 }'
+rm -rf $TEMP
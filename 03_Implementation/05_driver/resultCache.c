@@ -0,0 +1,341 @@
+#include <sys/stat.h>
+
+/**
+ * Persistent store of the results of single runs, such that a configuration which was
+ * already searched (on any host sharing the store) is answered without searching again.
+ * An entry is addressed by a hash of the model source (with all files it includes, as listed
+ * by the preprocessor), the version of CBMC or of the compiler, and the normalized options of
+ * the run. It consists of
+ * the file key.result, holding the verdict, the elapsed time, the origin of the result and,
+ * after an empty line, the output of the run between header and footer, and of the protocol
+ * record key.record if a protocol was recorded.
+ */
+
+/**
+ * Largest depth of nested includes followed when hashing a model.
+ */
+#define MAX_INCLUDE_DEPTH 8
+
+/**
+ * Number of hexadecimal digits of a key.
+ */
+#define CACHE_KEY_DIGITS 32
+
+struct cacheKey {
+    uint64_t hash[2];
+    char text[CACHE_KEY_DIGITS + 1];
+};
+
+struct cachedResult {
+    int status;
+    double seconds;
+    char host[256];
+    char timestamp[128];
+};
+
+void initCacheKey(struct cacheKey *key) {
+    // The offset bases of 64-bit FNV-1a and of a second, independent variant.
+    key->hash[0] = 0xcbf29ce484222325ULL;
+    key->hash[1] = 0x84222325cbf29ce4ULL;
+    key->text[0] = 0;
+}
+
+void hashBytes(struct cacheKey *key, const void *data, size_t size) {
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        key->hash[0] = (key->hash[0] ^ bytes[i]) * 0x100000001b3ULL;
+        key->hash[1] = (key->hash[1] ^ bytes[i] ^ 0x5a) * 0x100000001b3ULL;
+        key->hash[1] ^= key->hash[1] >> 29;
+    }
+}
+
+/**
+ * Hashes a string including its terminator, such that consecutive strings stay separated.
+ */
+void hashString(struct cacheKey *key, const char *text) {
+    hashBytes(key, text, strlen(text) + 1);
+}
+
+/**
+ * Hashes the contents of the file at path and of all files it includes with
+ * '#include "file"', relative to its folder. Missing files are hashed as their name only.
+ */
+void hashSource(struct cacheKey *key, const char *path, unsigned int depth) {
+    hashString(key, strrchr(path, '/') ? strrchr(path, '/') + 1 : path);
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        return;
+    }
+    char line[4096];
+    while (fgets(line, sizeof(line), in)) {
+        hashString(key, line);
+        const char *directive = line + strspn(line, " \t");
+        if (depth >= MAX_INCLUDE_DEPTH || strncmp(directive, "#include", 8)) {
+            continue;
+        }
+        const char *name = strchr(directive, '"');
+        const char *end = name ? strchr(name + 1, '"') : NULL;
+        if (!end) {
+            continue;
+        }
+        char included[4096];
+        const char *slash = strrchr(path, '/');
+        if (slash) {
+            snprintf(included, sizeof(included), "%.*s/%.*s", (int)(slash - path), path,
+                     (int)(end - name - 1), name + 1);
+        } else {
+            snprintf(included, sizeof(included), "%.*s", (int)(end - name - 1), name + 1);
+        }
+        hashSource(key, included, depth + 1);
+    }
+    fclose(in);
+}
+
+/**
+ * Hashes the contents of all files which model includes under the given definitions (in the
+ * form 'NAME=VALUE'), where the files are listed by 'compiler -MM' (without the system
+ * headers). Unlike the include lines followed by hashSource, this covers the generated
+ * tables, which are included by computed names (see shared/generatedTables.h).
+ * Returns 1 if the files could be listed.
+ */
+unsigned int hashIncludedFiles(struct cacheKey *key, const char *compiler, const char *model,
+                               char *const *definitions, unsigned int numberDefinitions) {
+    char **list = malloc((2 * numberDefinitions + 4) * sizeof(char *));
+    unsigned int numberList = 0;
+    list[numberList++] = (char *)compiler;
+    list[numberList++] = "-MM";
+    for (unsigned int i = 0; i < numberDefinitions; i++) {
+        list[numberList++] = "-D";
+        list[numberList++] = definitions[i];
+    }
+    list[numberList++] = (char *)model;
+    list[numberList] = NULL;
+    FILE *dependencies = captureOutput(list);
+    free(list);
+    if (!dependencies) {
+        return 0;
+    }
+    // The rule 'model.o: file file \' lists the files separated by spaces and line breaks.
+    char word[4096];
+    while (fscanf(dependencies, "%4095s", word) == 1) {
+        size_t length = strlen(word);
+        if (strcmp(word, "\\") && word[length - 1] != ':') {
+            hashSource(key, word, MAX_INCLUDE_DEPTH);
+        }
+    }
+    fclose(dependencies);
+    return 1;
+}
+
+int compareStrings(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/**
+ * Computes the key of a run of model with the given engine and version, where arguments are
+ * the arguments of the run after the binary, without the model. Definitions are normalized
+ * to the form '-DNAME=VALUE' and sorted, since their order does not matter. The order of
+ * all other arguments is kept. The files of the model are listed by the preprocessor of
+ * compiler under the definitions. Returns 0 if they cannot be listed.
+ */
+unsigned int computeCacheKey(struct cacheKey *key, const char *compiler, const char *model,
+                             const char *engine, const char *version, char *const *arguments,
+                             unsigned int numberArguments) {
+    initCacheKey(key);
+    hashString(key, engine);
+    hashString(key, version);
+    char **definitions = malloc((numberArguments + 1) * sizeof(char *));
+    unsigned int numberDefinitions = 0;
+    for (unsigned int i = 0; i < numberArguments; i++) {
+        if (!strcmp(arguments[i], "-D") && i + 1 < numberArguments) {
+            definitions[numberDefinitions++] = arguments[++i];
+        } else if (!strncmp(arguments[i], "-D", 2)) {
+            definitions[numberDefinitions++] = arguments[i] + 2;
+        } else {
+            hashString(key, arguments[i]);
+        }
+    }
+    qsort(definitions, numberDefinitions, sizeof(char *), compareStrings);
+    for (unsigned int i = 0; i < numberDefinitions; i++) {
+        hashString(key, "-D");
+        hashString(key, definitions[i]);
+    }
+    unsigned int listed = hashIncludedFiles(key, compiler, model, definitions, numberDefinitions);
+    free(definitions);
+    snprintf(key->text, sizeof(key->text), "%016llx%016llx",
+             (unsigned long long)key->hash[0], (unsigned long long)key->hash[1]);
+    return listed;
+}
+
+/**
+ * Creates the folder path and its parents. Returns 1 if it exists afterwards.
+ */
+unsigned int makeFolders(const char *path) {
+    char partial[4096];
+    snprintf(partial, sizeof(partial), "%s", path);
+    for (char *c = partial + 1; *c; c++) {
+        if (*c == '/') {
+            *c = 0;
+            mkdir(partial, 0777);
+            *c = '/';
+        }
+    }
+    mkdir(partial, 0777);
+    struct stat info;
+    return !stat(partial, &info) && S_ISDIR(info.st_mode);
+}
+
+/**
+ * Returns 1 if the status is worth storing: a verdict, or a timeout as a lower bound on the
+ * time the search needs.
+ */
+unsigned int isCacheableStatus(int status) {
+    return status == STATUS_PROTOCOL_FOUND || status == 0 || status == STATUS_TIMEOUT;
+}
+
+/**
+ * Reads the entry of key from folder. If output is not NULL, the stored output is copied to
+ * output and the terminal. Returns 1 if the entry exists.
+ */
+unsigned int readCachedResult(const char *folder, const struct cacheKey *key,
+                              struct cachedResult *result, FILE *output) {
+    char path[4096], line[4096];
+    snprintf(path, sizeof(path), "%s/%s.result", folder, key->text);
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        return 0;
+    }
+    memset(result, 0, sizeof(struct cachedResult));
+    unsigned int fields = 0;
+    while (fgets(line, sizeof(line), in) && line[0] != '\n') {
+        line[strcspn(line, "\n")] = 0;
+        char *value = strchr(line, ' ');
+        if (!value) {
+            continue;
+        }
+        *value++ = 0;
+        if (!strcmp(line, "status")) {
+            result->status = atoi(value);
+            fields |= 1;
+        } else if (!strcmp(line, "seconds")) {
+            result->seconds = strtod(value, NULL);
+            fields |= 2;
+        } else if (!strcmp(line, "host")) {
+            snprintf(result->host, sizeof(result->host), "%s", value);
+        } else if (!strcmp(line, "timestamp")) {
+            snprintf(result->timestamp, sizeof(result->timestamp), "%s", value);
+        }
+    }
+    if (fields != 3 || !isCacheableStatus(result->status)) {
+        fclose(in);
+        return 0;
+    }
+    if (output) {
+        char buffer[65536];
+        size_t size;
+        while ((size = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+            fwrite(buffer, 1, size, output);
+            fwrite(buffer, 1, size, stdout);
+        }
+    }
+    fclose(in);
+    return 1;
+}
+
+/**
+ * Returns 1 if the entry answers a run with the given timeout (0 for none): verdicts always
+ * do, and a timeout does if the new run would not run longer than the stored one.
+ */
+unsigned int answersRun(const struct cachedResult *result, double timeout) {
+    if (result->status != STATUS_TIMEOUT) {
+        return 1;
+    }
+    return timeout > 0 && timeout <= result->seconds;
+}
+
+/**
+ * Writes path atomically from the bytes [begin, end) of the file source.
+ */
+unsigned int copyToCache(FILE *source, long begin, long end, const char *path,
+                         const char *prefix) {
+    char temporary[4096];
+    snprintf(temporary, sizeof(temporary), "%s.%ld.tmp", path, (long)getpid());
+    FILE *out = fopen(temporary, "w");
+    if (!out) {
+        return 0;
+    }
+    fputs(prefix, out);
+    char buffer[65536];
+    fseek(source, begin, SEEK_SET);
+    for (long left = end - begin; left > 0;) {
+        size_t size = fread(buffer, 1, left < (long)sizeof(buffer) ? (size_t)left
+                                                                    : sizeof(buffer), source);
+        if (!size) {
+            break;
+        }
+        fwrite(buffer, 1, size, out);
+        left -= (long)size;
+    }
+    unsigned int written = !ferror(out);
+    written &= !fclose(out);
+    if (!written || rename(temporary, path)) {
+        remove(temporary);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Stores the result of a run under key, where the bytes [begin, end) of the output file
+ * outPath are the output of the run and recordPath its protocol record (if it exists).
+ * A stored verdict is never replaced by a timeout, and a timeout only by a longer one.
+ */
+void storeCachedResult(const char *folder, const struct cacheKey *key,
+                       const struct cachedResult *result, const char *outPath, long begin,
+                       long end, const char *recordPath) {
+    struct cachedResult previous;
+    if (!isCacheableStatus(result->status)
+        || (readCachedResult(folder, key, &previous, NULL)
+            && (previous.status != STATUS_TIMEOUT
+                || (result->status == STATUS_TIMEOUT && previous.seconds >= result->seconds)))) {
+        return;
+    }
+    if (!makeFolders(folder)) {
+        fprintf(stderr, "Cannot create the result cache %s.\n", folder);
+        return;
+    }
+    FILE *source = fopen(outPath, "r");
+    if (!source) {
+        return;
+    }
+    char path[4096], prefix[1024];
+    struct protocolRecord record;
+    if (readProtocolRecord(recordPath, &record)) {
+        snprintf(path, sizeof(path), "%s/%s.record", folder, key->text);
+        writeProtocolRecord(path, &record);
+        freeProtocolRecord(&record);
+    }
+    snprintf(prefix, sizeof(prefix), "status %d\nseconds %.3f\nhost %s\ntimestamp %s\n\n",
+             result->status, result->seconds, result->host, result->timestamp);
+    snprintf(path, sizeof(path), "%s/%s.result", folder, key->text);
+    if (!copyToCache(source, begin, end, path, prefix)) {
+        fprintf(stderr, "Cannot write %s.\n", path);
+    }
+    fclose(source);
+}
+
+/**
+ * Copies the protocol record of key from folder to recordPath. Returns 1 if one exists.
+ */
+unsigned int restoreCachedRecord(const char *folder, const struct cacheKey *key,
+                                 const char *recordPath) {
+    char path[4096];
+    struct protocolRecord record;
+    if (snprintf(path, sizeof(path), "%s/%s.record", folder, key->text) >= (int)sizeof(path)
+        || !readProtocolRecord(path, &record)) {
+        return 0;
+    }
+    unsigned int written = writeProtocolRecord(recordPath, &record);
+    freeProtocolRecord(&record);
+    return written;
+}
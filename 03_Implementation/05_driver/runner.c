@@ -0,0 +1,401 @@
+#include <ctype.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdint.h>
+
+/**
+ * Single runs of a model under CBMC or the native search, as previously done by the shell
+ * runners: the constants of the models are computed exactly, the output is written to the
+ * terminal and to an output file with a header and a footer, and the run is stopped after
+ * a timeout.
+ */
+
+/**
+ * Largest number of cards whose number of permutations fits into 64 bits.
+ */
+#define MAX_RUN_CARDS 20
+
+/**
+ * Length of the list subgroupSizes in the models. Longer lists are not passed, in which
+ * case the models do not restrict the permutation set sizes (they only do so for N <= 5).
+ */
+#define MAX_SUBGROUP_SIZES 13
+
+/**
+ * Exit status of timeout(1), which the runners used before.
+ */
+#define STATUS_TIMEOUT 124
+
+/**
+ * Number of subgroups of S_n (i.e., of closed shuffles) for n <= 8, used if the subgroup
+ * catalogue cannot be read.
+ */
+static const unsigned long long numberClosedShuffles[] = {
+    0, 1, 2, 6, 30, 156, 1455, 11300, 151221
+};
+
+struct runConstants {
+    unsigned long long possiblePermutations;
+    unsigned long long possibleSequences;
+    /**
+     * Number of closed shuffles, 0 if unknown.
+     */
+    unsigned long long permSetSize;
+    /**
+     * The orders of the proper nontrivial subgroups of S_n in increasing order. If
+     * subgroupSizesKnown is 0, they could not be determined.
+     */
+    unsigned int subgroupSizesKnown;
+    unsigned int numberSubgroupSizes;
+    unsigned int *subgroupSizes;
+};
+
+/**
+ * Returns n! or 0 if it does not fit into 64 bits.
+ */
+unsigned long long factorial(unsigned int n) {
+    unsigned long long result = 1;
+    for (unsigned int i = 2; i <= n; i++) {
+        if (result > UINT64_MAX / i) {
+            return 0;
+        }
+        result *= i;
+    }
+    return result;
+}
+
+/**
+ * Returns the binomial coefficient (n choose k). Every intermediate value is itself a
+ * binomial coefficient, so the division is exact and nothing overflows for n <= 62.
+ */
+unsigned long long binomial(unsigned int n, unsigned int k) {
+    unsigned long long result = 1;
+    for (unsigned int i = 0; i < k; i++) {
+        result = result * (n - i) / (i + 1);
+    }
+    return result;
+}
+
+/**
+ * Number of distinct sequences of the deck of the runners: each of the first numSym - 1
+ * symbols is on n / numSym cards and the last symbol on the remaining cards.
+ */
+unsigned long long numberSequences(unsigned int n, unsigned int numSym) {
+    unsigned long long result = 1;
+    unsigned int remaining = n;
+    for (unsigned int i = 0; i + 1 < numSym; i++) {
+        result *= binomial(remaining, n / numSym);
+        remaining -= n / numSym;
+    }
+    return result;
+}
+
+/**
+ * Reads the distinct subgroup orders from the catalogue written by generateSubgroups.c,
+ * which lists the subgroups sorted by their order. The trivial group and S_n are left out.
+ * Returns 0 if the catalogue cannot be read.
+ */
+unsigned int readSubgroupSizes(const char *path, unsigned int n, struct runConstants *constants) {
+    FILE *in = fopen(path, "rb");
+    if (!in) {
+        return 0;
+    }
+    char magic[4];
+    uint32_t header[2];
+    if (fread(magic, 1, 4, in) != 4 || memcmp(magic, "SGRP", 4)
+        || fread(header, sizeof(uint32_t), 2, in) != 2 || header[0] != n) {
+        fclose(in);
+        return 0;
+    }
+    uint32_t *orders = malloc(header[1] * sizeof(uint32_t));
+    if (fread(orders, sizeof(uint32_t), header[1], in) != header[1]) {
+        free(orders);
+        fclose(in);
+        return 0;
+    }
+    fclose(in);
+    constants->permSetSize = header[1];
+    constants->subgroupSizes = malloc(header[1] * sizeof(unsigned int));
+    constants->numberSubgroupSizes = 0;
+    for (uint32_t i = 0; i < header[1]; i++) {
+        if (orders[i] > 1 && orders[i] < constants->possiblePermutations
+            && (!constants->numberSubgroupSizes
+                || constants->subgroupSizes[constants->numberSubgroupSizes - 1] != orders[i])) {
+            constants->subgroupSizes[constants->numberSubgroupSizes++] = orders[i];
+        }
+    }
+    constants->subgroupSizesKnown = 1;
+    free(orders);
+    return 1;
+}
+
+/**
+ * Computes the constants which the models expect for n cards with numSym symbols. The subgroup
+ * orders are taken from the catalogue, such that they are exact for all n it exists for.
+ */
+void computeRunConstants(unsigned int n, unsigned int numSym, const char *cataloguePath,
+                         struct runConstants *constants) {
+    memset(constants, 0, sizeof(struct runConstants));
+    constants->possiblePermutations = factorial(n);
+    constants->possibleSequences = numberSequences(n, numSym);
+    if (!readSubgroupSizes(cataloguePath, n, constants)
+        && n < sizeof(numberClosedShuffles) / sizeof(numberClosedShuffles[0])) {
+        constants->permSetSize = numberClosedShuffles[n];
+    }
+}
+
+/**
+ * Parses a duration like timeout(1), i.e., a number with an optional suffix s, m, h or d.
+ * Returns the number of seconds, 0 for no timeout or -1 if the duration is invalid.
+ */
+double parseDuration(const char *duration) {
+    char *end;
+    double seconds = strtod(duration, &end);
+    if (end == duration || seconds < 0) {
+        return -1;
+    }
+    switch (*end) {
+    case 0:
+    case 's':
+        break;
+    case 'm':
+        seconds *= 60;
+        break;
+    case 'h':
+        seconds *= 3600;
+        break;
+    case 'd':
+        seconds *= 86400;
+        break;
+    default:
+        return -1;
+    }
+    return (*end && end[1]) ? -1 : seconds;
+}
+
+/**
+ * Writes the options in the form of the header of the output files, e.g.,
+ * "-D WEAK_SECURITY=2 --refine" as "WEAK_SECURITY = 2, refine".
+ */
+void printOptions(FILE *out, char *const *options, unsigned int numberOptions) {
+    unsigned int first = 1;
+    for (unsigned int i = 0; i < numberOptions; i++) {
+        const char *option = options[i];
+        if (!strcmp(option, "-D")) {
+            continue;
+        }
+        option += strspn(option, "-");
+        fprintf(out, "%s", first ? "" : ", ");
+        first = 0;
+        for (; *option; option++) {
+            if (*option == '=') {
+                fprintf(out, " = ");
+            } else {
+                fputc(*option, out);
+            }
+        }
+    }
+}
+
+/**
+ * Reads the available output of the pipe (waiting at most wait milliseconds, -1 for no
+ * limit) and writes it to out and to the terminal or consume. Returns the number of bytes,
+ * 0 at the end of the output and -1 if nothing arrived or poll was interrupted.
+ */
+ssize_t teeOutput(struct pollfd *reader, int wait, FILE *out,
+                  void (*consume)(void *context, const char *data, size_t size), void *context) {
+    int ready = poll(reader, 1, wait);
+    if (ready <= 0) {
+        return -1;
+    }
+    char buffer[65536];
+    ssize_t size = read(reader->fd, buffer, sizeof(buffer));
+    if (size < 0) {
+        return errno == EINTR ? -1 : 0;
+    }
+    fwrite(buffer, 1, size, out);
+    if (consume) {
+        consume(context, buffer, (size_t)size);
+    } else {
+        fwrite(buffer, 1, size, stdout);
+        fflush(stdout);
+    }
+    return size;
+}
+
+/**
+ * Runs argv and writes its output (and its error output) to out and, if consume is NULL, to
+ * the terminal. Otherwise, the output is passed to consume instead of the terminal.
+ * The process (with all processes it spawns) is stopped after timeout seconds if timeout
+ * is positive, or if the driver is interrupted. Its output while it stops is kept, such
+ * that the native search can report its last checkpoint.
+ * Returns its exit status, STATUS_TIMEOUT after a timeout or 128 + signal number.
+ */
+int runTeed(char *const *argv, FILE *out, double timeout,
+            void (*consume)(void *context, const char *data, size_t size), void *context) {
+    int pipeEnds[2];
+    if (pipe(pipeEnds)) {
+        fprintf(stderr, "Cannot create a pipe: %s\n", strerror(errno));
+        return 127;
+    }
+    fflush(stdout);
+    fflush(out);
+    struct timespec begin;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    pid_t pid = fork();
+    if (pid == 0) {
+        setpgid(0, 0);
+        close(pipeEnds[0]);
+        dup2(pipeEnds[1], STDOUT_FILENO);
+        dup2(pipeEnds[1], STDERR_FILENO);
+        close(pipeEnds[1]);
+        execvp(argv[0], argv);
+        fprintf(stderr, "Cannot execute %s: %s\n", argv[0], strerror(errno));
+        _exit(127);
+    }
+    close(pipeEnds[1]);
+    if (pid < 0) {
+        fprintf(stderr, "Cannot fork: %s\n", strerror(errno));
+        close(pipeEnds[0]);
+        return 127;
+    }
+    setpgid(pid, pid);
+
+    unsigned int timedOut = 0;
+    struct pollfd reader = { pipeEnds[0], POLLIN, 0 };
+    for (;;) {
+        int wait = -1;
+        if (timeout > 0) {
+            double left = timeout - secondsSince(&begin);
+            wait = left > 0 ? (int)(left * 1000) + 1 : 0;
+        }
+        ssize_t size = teeOutput(&reader, wait, out, consume, context);
+        if (poolInterrupted || (size < 0 && timeout > 0 && secondsSince(&begin) >= timeout)) {
+            timedOut = !poolInterrupted;
+            break;
+        }
+        if (!size) {
+            break;
+        }
+    }
+
+    int status;
+    if (timedOut || poolInterrupted) {
+        killpg(pid, SIGTERM);
+        unsigned int open = 1;
+        for (unsigned int t = 0; t < 10 * KILL_GRACE_SECONDS; t++) {
+            if (waitpid(pid, &status, WNOHANG) == pid) {
+                while (open && teeOutput(&reader, 0, out, consume, context) > 0) {
+                }
+                close(pipeEnds[0]);
+                return timedOut ? STATUS_TIMEOUT : 128 + SIGINT;
+            }
+            open = open && teeOutput(&reader, 100, out, consume, context) != 0;
+            if (!open) {
+                usleep(100000);
+            }
+        }
+        close(pipeEnds[0]);
+        killpg(pid, SIGKILL);
+        waitpid(pid, &status, 0);
+        return timedOut ? STATUS_TIMEOUT : 128 + SIGINT;
+    }
+    close(pipeEnds[0]);
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            return 127;
+        }
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
+/**
+ * Runs argv in the foreground with inherited output. Returns its exit status.
+ */
+int runCommand(char *const *argv) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        execvp(argv[0], argv);
+        fprintf(stderr, "Cannot execute %s: %s\n", argv[0], strerror(errno));
+        _exit(127);
+    }
+    if (pid < 0) {
+        return 127;
+    }
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            return 127;
+        }
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
+void ignoreOutput(void *context, const char *data, size_t size) {
+    (void)context;
+    (void)data;
+    (void)size;
+}
+
+/**
+ * Runs argv with its output (and error output) written to a temporary file, which is
+ * returned at its beginning, or NULL if the command fails.
+ */
+FILE *captureOutput(char *const *argv) {
+    FILE *output = tmpfile();
+    if (!output) {
+        return NULL;
+    }
+    if (runTeed(argv, output, 0, ignoreOutput, NULL)) {
+        fclose(output);
+        return NULL;
+    }
+    rewind(output);
+    return output;
+}
+
+/**
+ * Writes the first line of the output of command into line, with the newline removed.
+ */
+void readFirstLine(const char *command, char *line, size_t size) {
+    line[0] = 0;
+    FILE *in = popen(command, "r");
+    if (!in) {
+        return;
+    }
+    if (fgets(line, (int)size, in)) {
+        line[strcspn(line, "\n")] = 0;
+    }
+    while (fgetc(in) != EOF) {
+    }
+    pclose(in);
+}
+
+/**
+ * Writes the current local time once as it is printed in the output files and once as it
+ * is used in their names.
+ */
+void formatStartTime(char *print, size_t printSize, char *name, size_t nameSize) {
+    time_t now = time(NULL);
+    strftime(print, printSize, "%Y-%m-%d %H:%M:%S %Z", localtime(&now));
+    snprintf(name, nameSize, "%s", print);
+    for (char *c = name; *c; c++) {
+        if (isspace((unsigned char)*c) || *c == '-' || *c == ':') {
+            *c = '_';
+        }
+    }
+}
+
+/**
+ * Writes the formatted text both to the terminal and to out.
+ */
+void printTeed(FILE *out, const char *format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    vfprintf(stdout, format, arguments);
+    va_end(arguments);
+    va_start(arguments, format);
+    vfprintf(out, format, arguments);
+    va_end(arguments);
+}
@@ -0,0 +1,482 @@
+#include <ctype.h>
+#include <stdarg.h>
+
+/**
+ * Streaming decoder for the counterexample traces of the models, which CBMC prints with
+ * '--json-ui --trace'. The JSON text is fed in chunks of any size and scanned once, keeping
+ * only the current trace step and the decoded protocol in memory, such that traces of
+ * several gigabytes are decoded in constant memory (in the size of the trace).
+ *
+ * The protocol is read from the nondeterministic choices of the models: the actions in
+ * performActions(), the permutation sets in applyShuffle(), the turn positions in applyTurn(),
+ * the observed branches (stateIdx), the modules in applyProtocols() and the result positions
+ * of the last call of isFinalState().
+ */
+
+/**
+ * Action types of the models.
+ */
+#define DECODED_TURN 0
+#define DECODED_SHUFFLE 1
+#define DECODED_PROTOCOL 2
+
+#define MAX_DECODED_ACTIONS 256
+#define MAX_JSON_DEPTH 64
+#define MAX_JSON_KEY 64
+
+/**
+ * Longer strings (e.g., the values of whole arrays) are truncated, since only
+ * scalar values are decoded. They are then rejected by copyText.
+ */
+#define MAX_JSON_TEXT 4096
+
+/**
+ * Maximal number of result positions, two per output bit.
+ */
+#define MAX_RESULT_POSITIONS 4
+
+struct decodedAction {
+    unsigned int type;
+    unsigned int position;
+    /**
+     * Index of the observed symbol after a turn, or of the end state of a module.
+     */
+    unsigned int branch;
+    unsigned int hasBranch;
+    unsigned int permSetSize;
+    /**
+     * Permutation ranks of a shuffle, permutations[i] is valid for i < permSetSize.
+     */
+    unsigned int *permutations;
+    unsigned int capacity;
+    /**
+     * Chosen module and its cards: two commitments and up to two helper cards.
+     */
+    unsigned int module;
+    unsigned int cards[6];
+};
+
+struct traceDecoder {
+    /**
+     * Number of cards, used to print the permutations (0 prints their ranks).
+     */
+    unsigned int n;
+    /**
+     * The description is written to the terminal and, if it is not NULL, to copy.
+     */
+    FILE *copy;
+
+    // State of the JSON scanner.
+    unsigned int depth;
+    char containers[MAX_JSON_DEPTH];
+    char keys[MAX_JSON_DEPTH][MAX_JSON_KEY];
+    unsigned int expectKey[MAX_JSON_DEPTH];
+    unsigned int inString;
+    unsigned int escape;
+    unsigned int inLiteral;
+    char text[MAX_JSON_TEXT];
+    size_t textLength;
+
+    // Depth of the current trace array and of the current step object, 0 outside of them.
+    unsigned int traceDepth;
+    unsigned int stepDepth;
+    char stepType[32];
+    char lhs[128];
+    char function[128];
+    char value[128];
+
+    // The protocol of the current trace.
+    struct decodedAction actions[MAX_DECODED_ACTIONS];
+    unsigned int numberActions;
+    unsigned int results[MAX_RESULT_POSITIONS];
+    unsigned int resultKnown[MAX_RESULT_POSITIONS];
+    unsigned int numberTraces;
+    char status[32];
+    /**
+     * If not NULL, the first decoded protocol is stored in this record.
+     */
+    struct protocolRecord *record;
+};
+
+void initTraceDecoder(struct traceDecoder *decoder, unsigned int n, FILE *copy) {
+    memset(decoder, 0, sizeof(struct traceDecoder));
+    decoder->n = n;
+    decoder->copy = copy;
+}
+
+void printDecoded(struct traceDecoder *decoder, const char *format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    vfprintf(stdout, format, arguments);
+    va_end(arguments);
+    if (decoder->copy) {
+        va_start(arguments, format);
+        vfprintf(decoder->copy, format, arguments);
+        va_end(arguments);
+    }
+}
+
+/**
+ * Writes the permutation with the given lexicographic rank as in the native search,
+ * e.g., rank 1 of four cards as [1 2 4 3].
+ */
+void printPermutation(struct traceDecoder *decoder, unsigned int rank) {
+    if (!decoder->n || decoder->n > MAX_RUN_CARDS) {
+        printDecoded(decoder, " #%u", rank);
+        return;
+    }
+    unsigned int unused[MAX_RUN_CARDS];
+    for (unsigned int i = 0; i < decoder->n; i++) {
+        unused[i] = i + 1;
+    }
+    unsigned long long remaining = rank;
+    printDecoded(decoder, " [");
+    for (unsigned int i = 0; i < decoder->n; i++) {
+        unsigned long long block = factorial(decoder->n - 1 - i);
+        unsigned int index = (unsigned int)(remaining / block);
+        remaining %= block;
+        printDecoded(decoder, "%s%u", i ? " " : "", unused[index]);
+        memmove(&unused[index], &unused[index + 1],
+                (decoder->n - 1 - i - index) * sizeof(unsigned int));
+    }
+    printDecoded(decoder, "]");
+}
+
+void printDecodedProtocol(struct traceDecoder *decoder) {
+    static const char *modules[] = { "FR_AND", "FR_XOR", "LV_AND", "LV_OR", "FR_COPY" };
+    decoder->numberTraces++;
+    printDecoded(decoder, "Decoded protocol %u with %u actions:\n",
+                 decoder->numberTraces, decoder->numberActions);
+    for (unsigned int i = 0; i < decoder->numberActions; i++) {
+        const struct decodedAction *action = &decoder->actions[i];
+        printDecoded(decoder, "  %u: ", i + 1);
+        if (action->type == DECODED_TURN) {
+            printDecoded(decoder, "TURN position %u", action->position + 1);
+            if (action->hasBranch) {
+                printDecoded(decoder, ", observed symbol %u", action->branch + 1);
+            }
+        } else if (action->type == DECODED_SHUFFLE) {
+            printDecoded(decoder, "SHUFFLE with %u permutation(s):", action->permSetSize);
+            for (unsigned int j = 0; j < action->permSetSize && j < action->capacity; j++) {
+                printPermutation(decoder, action->permutations[j]);
+            }
+        } else if (action->type == DECODED_PROTOCOL) {
+            printDecoded(decoder, "PROTOCOL %s on (%u, %u) and (%u, %u)",
+                         action->module < 5 ? modules[action->module] : "?",
+                         action->cards[0] + 1, action->cards[1] + 1,
+                         action->cards[2] + 1, action->cards[3] + 1);
+            if (action->module == 2) {
+                printDecoded(decoder, " with helper %u", action->cards[4] + 1);
+            } else if (action->module == 0 || action->module == 4) {
+                printDecoded(decoder, " with helpers %u and %u",
+                             action->cards[4] + 1, action->cards[5] + 1);
+            }
+            if (action->hasBranch) {
+                printDecoded(decoder, ", end state %u", action->branch + 1);
+            }
+        } else {
+            printDecoded(decoder, "no action (%u)", action->type);
+        }
+        printDecoded(decoder, "\n");
+    }
+    if (decoder->resultKnown[0] && decoder->resultKnown[1]) {
+        printDecoded(decoder, "  RESULT: positions %u and %u encode the %soutput bit",
+                     decoder->results[0] + 1, decoder->results[1] + 1,
+                     decoder->resultKnown[2] ? "first " : "");
+        if (decoder->resultKnown[2] && decoder->resultKnown[3]) {
+            printDecoded(decoder, ", positions %u and %u the second one",
+                         decoder->results[2] + 1, decoder->results[3] + 1);
+        }
+        printDecoded(decoder, ".\n");
+    }
+}
+
+/**
+ * Stores the decoded protocol in the record of the decoder. The states are not part of
+ * the trace, hence the record contains none.
+ */
+void recordDecodedProtocol(struct traceDecoder *decoder) {
+    struct protocolRecord *record = decoder->record;
+    record->engine = RECORD_ENGINE_CBMC;
+    for (unsigned int i = 0; i < MAX_RESULT_POSITIONS && decoder->resultKnown[i]; i++) {
+        record->results[record->numberResults++] = decoder->results[i];
+    }
+    record->length = decoder->numberActions;
+    record->actions = calloc(decoder->numberActions + 1, sizeof(struct recordAction));
+    for (unsigned int i = 0; i < decoder->numberActions; i++) {
+        const struct decodedAction *decoded = &decoder->actions[i];
+        struct recordAction *action = &record->actions[i];
+        action->type = decoded->type;
+        action->branch = decoded->branch;
+        if (decoded->type == DECODED_TURN) {
+            action->position = decoded->position;
+        } else if (decoded->type == DECODED_SHUFFLE) {
+            action->permSetSize = decoded->permSetSize < decoded->capacity
+                                  ? decoded->permSetSize : decoded->capacity;
+            action->permutations = malloc((action->permSetSize + 1) * sizeof(unsigned int));
+            memcpy(action->permutations, decoded->permutations,
+                   action->permSetSize * sizeof(unsigned int));
+        } else if (decoded->type == DECODED_PROTOCOL) {
+            action->position = decoded->module;
+            action->permSetSize = 6;
+            action->permutations = malloc(6 * sizeof(unsigned int));
+            memcpy(action->permutations, decoded->cards, 6 * sizeof(unsigned int));
+        }
+    }
+}
+
+void resetDecodedProtocol(struct traceDecoder *decoder) {
+    for (unsigned int i = 0; i < MAX_DECODED_ACTIONS; i++) {
+        free(decoder->actions[i].permutations);
+    }
+    memset(decoder->actions, 0, sizeof(decoder->actions));
+    memset(decoder->resultKnown, 0, sizeof(decoder->resultKnown));
+    decoder->numberActions = 0;
+}
+
+/**
+ * Decodes an assignment of the trace. The values are printed by CBMC in decimal or, with
+ * --trace-hex, in hexadecimal, possibly with a suffix like 'u'.
+ */
+void decodeAssignment(struct traceDecoder *decoder) {
+    const char *function = decoder->function;
+    const char *lhs = decoder->lhs;
+    // Values which are too long (e.g., whole arrays) were rejected and are not decoded.
+    if (!decoder->value[0]) {
+        return;
+    }
+    unsigned int value = (unsigned int)strtoul(decoder->value, NULL, 0);
+    struct decodedAction *current = decoder->numberActions
+                                    ? &decoder->actions[decoder->numberActions - 1] : NULL;
+
+    if (!strcmp(function, "performActions")) {
+        if (!strcmp(lhs, "action") && decoder->numberActions < MAX_DECODED_ACTIONS) {
+            current = &decoder->actions[decoder->numberActions++];
+            current->type = value;
+        } else if (!strcmp(lhs, "stateIdx") && current) {
+            current->branch = value;
+            current->hasBranch = 1;
+        }
+    } else if (!current) {
+        // Assignments before the first action belong to the start state.
+    } else if (!strcmp(function, "applyTurn")) {
+        if (!strcmp(lhs, "turnPosition")) {
+            current->position = value;
+        }
+    } else if (!strcmp(function, "applyShuffle")) {
+        if (!strcmp(lhs, "permSetSize")) {
+            current->permSetSize = value;
+        } else if (!strncmp(lhs, "permIndices[", 12)) {
+            unsigned int index = (unsigned int)strtoul(lhs + 12, NULL, 0);
+            if (index >= current->capacity && index < (1u << 24)) {
+                unsigned int capacity = current->capacity ? current->capacity : 8;
+                while (capacity <= index) {
+                    capacity *= 2;
+                }
+                current->permutations = realloc(current->permutations,
+                                                capacity * sizeof(unsigned int));
+                memset(current->permutations + current->capacity, 0,
+                       (capacity - current->capacity) * sizeof(unsigned int));
+                current->capacity = capacity;
+            }
+            if (index < current->capacity) {
+                current->permutations[index] = value;
+            }
+        }
+    } else if (!strcmp(function, "applyProtocols")) {
+        static const char *cards[] = { "com1A", "com1B", "com2A", "com2B", "help1", "help2" };
+        if (!strcmp(lhs, "protocolChosen")) {
+            current->module = value;
+        } else if (!strcmp(lhs, "stateIdx")) {
+            current->branch = value;
+            current->hasBranch = 1;
+        }
+        for (unsigned int i = 0; i < 6; i++) {
+            if (!strcmp(lhs, cards[i])) {
+                current->cards[i] = value;
+            }
+        }
+    } else if (!strcmp(function, "isFinalState")) {
+        // The last call of isFinalState() is the one for the final state.
+        if (lhs[0] >= 'a' && lhs[0] < 'a' + MAX_RESULT_POSITIONS && !lhs[1]) {
+            decoder->results[lhs[0] - 'a'] = value;
+            decoder->resultKnown[lhs[0] - 'a'] = 1;
+        }
+    }
+}
+
+/**
+ * Copies the token text of the given length into target. A token which does not fit is
+ * rejected (target is left empty), such that it never matches a cut-off name or value.
+ * Returns 1 if the token was copied.
+ */
+unsigned int copyText(char *target, size_t size, const char *text, size_t length) {
+    if (length >= size) {
+        target[0] = 0;
+        return 0;
+    }
+    snprintf(target, size, "%.*s", (int)length, text);
+    return 1;
+}
+
+/**
+ * A scalar value (string or literal) was read in the current container.
+ */
+void decodeValue(struct traceDecoder *decoder) {
+    unsigned int depth = decoder->depth;
+    if (!depth || depth > MAX_JSON_DEPTH || decoder->containers[depth - 1] != '{') {
+        return;
+    }
+    const char *key = decoder->keys[depth - 1];
+    if (!strcmp(key, "cProverStatus")) {
+        copyText(decoder->status, sizeof(decoder->status), decoder->text, decoder->textLength);
+    }
+    if (!decoder->stepDepth) {
+        return;
+    }
+    if (depth == decoder->stepDepth) {
+        if (!strcmp(key, "stepType")) {
+            copyText(decoder->stepType, sizeof(decoder->stepType),
+                     decoder->text, decoder->textLength);
+        } else if (!strcmp(key, "lhs")) {
+            copyText(decoder->lhs, sizeof(decoder->lhs), decoder->text, decoder->textLength);
+        }
+    } else if (depth == decoder->stepDepth + 1) {
+        const char *parent = decoder->keys[depth - 2];
+        if (!strcmp(parent, "value") && !strcmp(key, "data")) {
+            copyText(decoder->value, sizeof(decoder->value), decoder->text, decoder->textLength);
+        } else if (!strcmp(parent, "sourceLocation") && !strcmp(key, "function")) {
+            copyText(decoder->function, sizeof(decoder->function),
+                     decoder->text, decoder->textLength);
+        }
+    }
+}
+
+/**
+ * A string or literal ended: it is either the key of the current object or a value.
+ */
+void endToken(struct traceDecoder *decoder, unsigned int isString) {
+    decoder->text[decoder->textLength] = 0;
+    unsigned int depth = decoder->depth;
+    if (isString && depth && depth <= MAX_JSON_DEPTH && decoder->containers[depth - 1] == '{'
+        && decoder->expectKey[depth - 1]) {
+        copyText(decoder->keys[depth - 1], MAX_JSON_KEY, decoder->text, decoder->textLength);
+        decoder->expectKey[depth - 1] = 0;
+    } else {
+        decodeValue(decoder);
+    }
+    decoder->textLength = 0;
+}
+
+void openContainer(struct traceDecoder *decoder, char container) {
+    unsigned int depth = decoder->depth;
+    if (container == '[' && depth && depth <= MAX_JSON_DEPTH && decoder->containers[depth - 1] == '{'
+        && !strcmp(decoder->keys[depth - 1], "trace")) {
+        decoder->traceDepth = depth + 1;
+        resetDecodedProtocol(decoder);
+    } else if (container == '{' && decoder->traceDepth && depth == decoder->traceDepth) {
+        decoder->stepDepth = depth + 1;
+        decoder->stepType[0] = decoder->lhs[0] = decoder->function[0] = decoder->value[0] = 0;
+    }
+    if (depth < MAX_JSON_DEPTH) {
+        decoder->containers[depth] = container;
+        decoder->keys[depth][0] = 0;
+        decoder->expectKey[depth] = (container == '{');
+    }
+    decoder->depth++;
+}
+
+void closeContainer(struct traceDecoder *decoder) {
+    if (!decoder->depth) {
+        return;
+    }
+    if (decoder->depth == decoder->stepDepth) {
+        if (!strcmp(decoder->stepType, "assignment")) {
+            decodeAssignment(decoder);
+        }
+        decoder->stepDepth = 0;
+    } else if (decoder->depth == decoder->traceDepth) {
+        printDecodedProtocol(decoder);
+        if (decoder->record && decoder->numberTraces == 1) {
+            recordDecodedProtocol(decoder);
+        }
+        resetDecodedProtocol(decoder);
+        decoder->traceDepth = 0;
+    }
+    decoder->depth--;
+}
+
+/**
+ * Scans the next chunk of the JSON text.
+ */
+void feedTraceDecoder(struct traceDecoder *decoder, const char *data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        char c = data[i];
+        if (decoder->inString) {
+            if (decoder->escape) {
+                decoder->escape = 0;
+            } else if (c == '\\') {
+                decoder->escape = 1;
+                continue;
+            } else if (c == '"') {
+                decoder->inString = 0;
+                endToken(decoder, 1);
+                continue;
+            }
+            if (decoder->textLength + 1 < MAX_JSON_TEXT) {
+                decoder->text[decoder->textLength++] = c;
+            }
+            continue;
+        }
+        if (decoder->inLiteral) {
+            if (isalnum((unsigned char)c) || c == '-' || c == '+' || c == '.') {
+                if (decoder->textLength + 1 < MAX_JSON_TEXT) {
+                    decoder->text[decoder->textLength++] = c;
+                }
+                continue;
+            }
+            decoder->inLiteral = 0;
+            endToken(decoder, 0);
+        }
+        unsigned int depth = decoder->depth;
+        switch (c) {
+        case '"':
+            decoder->inString = 1;
+            decoder->textLength = 0;
+            break;
+        case '{':
+        case '[':
+            openContainer(decoder, c);
+            break;
+        case '}':
+        case ']':
+            closeContainer(decoder);
+            break;
+        case ',':
+            if (depth && depth <= MAX_JSON_DEPTH && decoder->containers[depth - 1] == '{') {
+                decoder->expectKey[depth - 1] = 1;
+            }
+            break;
+        default:
+            if (isalnum((unsigned char)c) || c == '-') {
+                decoder->inLiteral = 1;
+                decoder->textLength = 0;
+                decoder->text[decoder->textLength++] = c;
+            }
+        }
+    }
+}
+
+/**
+ * Finishes the decoding. Returns the number of decoded traces.
+ */
+unsigned int finishTraceDecoder(struct traceDecoder *decoder) {
+    if (decoder->status[0]) {
+        printDecoded(decoder, "CBMC status: %s\n", decoder->status);
+    }
+    if (!decoder->numberTraces) {
+        printDecoded(decoder, "The output contains no trace.\n");
+    }
+    resetDecodedProtocol(decoder);
+    return decoder->numberTraces;
+}
@@ -0,0 +1,304 @@
+/**
+ * Exact unwinding bounds of the loops of a model for CBMC, such that the symbolic execution
+ * does not need to discover them. The loops are listed by 'cbmc --show-loops' with their
+ * source lines, and the bound of every counting loop 'for (... i = start; i < end; i++)'
+ * (or with '<=') is evaluated with the macros of the model under the options of the run.
+ * The macros are printed by the preprocessor of the compiler and the bounds are computed by
+ * a small probe program, such that they are exactly the ones of the model. Loops whose
+ * bounds are not constant (e.g., depending on a parameter) are left to CBMC.
+ */
+
+/**
+ * Largest number of loops of a model.
+ */
+#define MAX_UNWIND_LOOPS 1024
+
+/**
+ * Exit status of a run in which an unwinding assertion failed. CBMC reports it with the
+ * status of a found protocol, but it only shows that a derived bound is too small, so the
+ * run has no verdict and is not stored in the result cache.
+ */
+#define STATUS_UNWINDING_FAILED 12
+
+struct loopBound {
+    char id[256];
+    char start[256];
+    char end[256];
+    unsigned int inclusive;
+};
+
+struct unwindSet {
+    /**
+     * The bounds as the argument of --unwindset, e.g. 'main.0:5,performActions.0:7'.
+     */
+    char *text;
+    unsigned int numberLoops;
+    unsigned int numberBounded;
+};
+
+/**
+ * Copies the text between begin and end without surrounding spaces into target.
+ */
+void copyTrimmed(char *target, size_t size, const char *begin, const char *end) {
+    while (begin < end && isspace((unsigned char)*begin)) {
+        begin++;
+    }
+    while (end > begin && isspace((unsigned char)end[-1])) {
+        end--;
+    }
+    snprintf(target, size, "%.*s", (int)(end - begin), begin);
+}
+
+/**
+ * Parses the header of a counting loop 'for (type i = start; i < end; i++)' in line.
+ * Returns 1 if the line holds such a loop.
+ */
+unsigned int parseCountingLoop(const char *line, struct loopBound *loop) {
+    const char *header = strstr(line, "for (");
+    if (!header) {
+        return 0;
+    }
+    header += 5;
+    const char *firstSemicolon = strchr(header, ';');
+    const char *secondSemicolon = firstSemicolon ? strchr(firstSemicolon + 1, ';') : NULL;
+    const char *assignment = strchr(header, '=');
+    if (!secondSemicolon || !assignment || assignment > firstSemicolon) {
+        return 0;
+    }
+    // The counter is the last word before the assignment.
+    const char *counterEnd = assignment;
+    while (counterEnd > header && isspace((unsigned char)counterEnd[-1])) {
+        counterEnd--;
+    }
+    const char *counter = counterEnd;
+    while (counter > header && (isalnum((unsigned char)counter[-1]) || counter[-1] == '_')) {
+        counter--;
+    }
+    size_t counterLength = (size_t)(counterEnd - counter);
+    if (!counterLength) {
+        return 0;
+    }
+    copyTrimmed(loop->start, sizeof(loop->start), assignment + 1, firstSemicolon);
+
+    const char *condition = firstSemicolon + 1;
+    condition += strspn(condition, " \t");
+    if (strncmp(condition, counter, counterLength)) {
+        return 0;
+    }
+    condition += counterLength;
+    condition += strspn(condition, " \t");
+    if (condition[0] != '<') {
+        return 0;
+    }
+    loop->inclusive = condition[1] == '=';
+    condition += loop->inclusive ? 2 : 1;
+    copyTrimmed(loop->end, sizeof(loop->end), condition, secondSemicolon);
+
+    // Only loops counting up by one are bounded.
+    char increment[256];
+    snprintf(increment, sizeof(increment), "%.*s++", (int)counterLength, counter);
+    const char *step = secondSemicolon + 1;
+    step += strspn(step, " \t");
+    return !strncmp(step, increment, strlen(increment)) && loop->start[0] && loop->end[0];
+}
+
+/**
+ * Returns 1 if every identifier of expression is one of the macros.
+ */
+unsigned int isConstantExpression(const char *expression, char **macros,
+                                  unsigned int numberMacros) {
+    for (const char *c = expression; *c;) {
+        if (isalpha((unsigned char)*c) || *c == '_') {
+            const char *begin = c;
+            while (isalnum((unsigned char)*c) || *c == '_') {
+                c++;
+            }
+            unsigned int found = 0;
+            for (unsigned int i = 0; !found && i < numberMacros; i++) {
+                found = strlen(macros[i]) == (size_t)(c - begin)
+                        && !strncmp(macros[i], begin, (size_t)(c - begin));
+            }
+            if (!found) {
+                return 0;
+            }
+        } else if (isdigit((unsigned char)*c)) {
+            while (isalnum((unsigned char)*c)) {
+                c++;
+            }
+        } else if (strchr(" \t()+-*/%<>=!&|^?:~", *c)) {
+            c++;
+        } else {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Reads the line with the given number of the file at path, where relative paths are also
+ * tried relative to directory. Returns 1 if the line exists.
+ */
+unsigned int readSourceLine(const char *path, const char *directory, unsigned int number,
+                            char *line, size_t size) {
+    FILE *in = fopen(path, "r");
+    if (!in && path[0] != '/') {
+        char joined[4096];
+        snprintf(joined, sizeof(joined), "%s/%s", directory, path);
+        in = fopen(joined, "r");
+    }
+    if (!in) {
+        return 0;
+    }
+    unsigned int found = 0;
+    for (unsigned int i = 1; !found && fgets(line, (int)size, in); i++) {
+        found = i == number;
+    }
+    fclose(in);
+    return found;
+}
+
+/**
+ * Derives the unwinding bounds of model, where showLoops is the command
+ * 'cbmc --show-loops ...' and preprocess the command '$CC -E -dM ...', both with the
+ * definitions of the run. Returns 1 if the set was derived.
+ */
+unsigned int deriveUnwindSet(char *const *showLoops, char *const *preprocess,
+                             const char *compiler, const char *directory,
+                             struct unwindSet *set) {
+    memset(set, 0, sizeof(struct unwindSet));
+    FILE *loops = captureOutput(showLoops);
+    if (!loops) {
+        fprintf(stderr, "Cannot list the loops of the model.\n");
+        return 0;
+    }
+    FILE *definitions = captureOutput(preprocess);
+    if (!definitions) {
+        fprintf(stderr, "Cannot preprocess the model.\n");
+        fclose(loops);
+        return 0;
+    }
+
+    // The probe program redefines the macros of the model, leaving out the reserved ones.
+    char probePath[4096], probeBinary[4096], line[4096];
+    const char *temporary = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    snprintf(probePath, sizeof(probePath), "%s/unwindProbe_%ld.c", temporary, (long)getpid());
+    snprintf(probeBinary, sizeof(probeBinary), "%s/unwindProbe_%ld", temporary, (long)getpid());
+    FILE *probe = fopen(probePath, "w");
+    if (!probe) {
+        fprintf(stderr, "Cannot write %s.\n", probePath);
+        fclose(loops);
+        fclose(definitions);
+        return 0;
+    }
+    fprintf(probe, "#include <stdio.h>\n");
+    char **macros = NULL;
+    unsigned int numberMacros = 0;
+    while (fgets(line, sizeof(line), definitions)) {
+        if (strncmp(line, "#define ", 8) || line[8] == '_') {
+            continue;
+        }
+        fputs(line, probe);
+        size_t nameLength = strspn(line + 8, "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz"
+                                              "0123456789_");
+        // Function-like macros are not constants.
+        if (line[8 + nameLength] != '(') {
+            macros = realloc(macros, (numberMacros + 1) * sizeof(char *));
+            macros[numberMacros++] = strndup(line + 8, nameLength);
+        }
+    }
+    fclose(definitions);
+
+    // Loops are listed as 'Loop function.k:' followed by their location.
+    struct loopBound *bounded = malloc(MAX_UNWIND_LOOPS * sizeof(struct loopBound));
+    unsigned int numberBounded = 0;
+    char id[256] = "";
+    fprintf(probe, "int main(void) {\n");
+    while (fgets(line, sizeof(line), loops)) {
+        line[strcspn(line, "\n")] = 0;
+        if (!strncmp(line, "Loop ", 5)) {
+            copyTrimmed(id, sizeof(id), line + 5, line + strlen(line));
+            id[strcspn(id, ":")] = 0;
+            set->numberLoops++;
+            continue;
+        }
+        char *file = strstr(line, "file ");
+        char *number = strstr(line, " line ");
+        if (!id[0] || !file || !number || numberBounded >= MAX_UNWIND_LOOPS) {
+            continue;
+        }
+        char path[4096], source[4096];
+        copyTrimmed(path, sizeof(path), file + 5, number);
+        struct loopBound *loop = &bounded[numberBounded];
+        if (readSourceLine(path, directory, (unsigned int)strtoul(number + 6, NULL, 10),
+                           source, sizeof(source))
+            && parseCountingLoop(source, loop)
+            && isConstantExpression(loop->start, macros, numberMacros)
+            && isConstantExpression(loop->end, macros, numberMacros)) {
+            snprintf(loop->id, sizeof(loop->id), "%s", id);
+            fprintf(probe, "    printf(\"%%lld\\n\", (long long)(%s) - (long long)(%s)%s);\n",
+                    loop->end, loop->start, loop->inclusive ? " + 1" : "");
+            numberBounded++;
+        }
+        id[0] = 0;
+    }
+    fprintf(probe, "    return 0;\n}\n");
+    fclose(probe);
+    fclose(loops);
+    for (unsigned int i = 0; i < numberMacros; i++) {
+        free(macros[i]);
+    }
+    free(macros);
+
+    char *compile[] = { (char *)compiler, "-w", probePath, "-o", probeBinary, NULL };
+    char *run[] = { probeBinary, NULL };
+    FILE *iterations = runCommand(compile) ? NULL : captureOutput(run);
+    remove(probePath);
+    remove(probeBinary);
+    if (!iterations) {
+        fprintf(stderr, "Cannot evaluate the loop bounds of the model.\n");
+        free(bounded);
+        return 0;
+    }
+    size_t size = 1;
+    set->text = calloc(1, 1);
+    for (unsigned int i = 0; i < numberBounded && fgets(line, sizeof(line), iterations); i++) {
+        long long count = strtoll(line, NULL, 10);
+        /**
+         * CBMC checks the loop condition once more after the last iteration, which is
+         * constant and thus free, such that the unwinding assertion holds.
+         */
+        char entry[512];
+        snprintf(entry, sizeof(entry), "%s%s:%lld", i ? "," : "", bounded[i].id,
+                 (count > 0 ? count : 0) + 1);
+        size += strlen(entry);
+        set->text = realloc(set->text, size);
+        strcat(set->text, entry);
+        set->numberBounded++;
+    }
+    fclose(iterations);
+    free(bounded);
+    return 1;
+}
+
+/**
+ * Returns 1 if the output of CBMC in path reports a failed unwinding assertion, either as
+ * '[f.unwind.k] ... unwinding assertion loop k: FAILURE' or, with --json-ui, as a result
+ * whose property 'f.unwind.k' has the status FAILURE.
+ */
+unsigned int hasFailedUnwinding(const char *path) {
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        return 0;
+    }
+    char line[4096];
+    unsigned int unwindProperty = 0;
+    unsigned int failed = 0;
+    while (!failed && fgets(line, sizeof(line), in)) {
+        if (strstr(line, "\"property\"")) {
+            unwindProperty = strstr(line, ".unwind.") != NULL;
+        }
+        failed = strstr(line, "FAILURE") && (unwindProperty || strstr(line, ".unwind."));
+    }
+    fclose(in);
+    return failed;
+}
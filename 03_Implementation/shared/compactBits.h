@@ -0,0 +1,61 @@
+/**
+ * Types of the values stored in states, included by the programs after N, NUM_SYM and
+ * WEAK_SECURITY are defined.
+ * With COMPACT_BITS set to 1, CBMC stores each value with the smallest number of bits it needs
+ * instead of 32 bits, which removes most of the bits of all adders and comparators from the
+ * formula:
+ *   - possibilities take 1 bit if only possibilistic security is checked,
+ *   - card symbols 1..NUM_SYM take ceil(log2(NUM_SYM + 1)) bits,
+ *   - card positions 0..N-1 take ceil(log2(N)) bits (at least 1).
+ * Exact fractions of probabilistic security keep 32 bits. Loop indices stay unsigned int, as
+ * CBMC unrolls all loops and replaces them by constants anyway.
+ * Without COMPACT_BITS (or when not compiled by CBMC), all values are unsigned int.
+ */
+#ifndef COMPACT_BITS
+#define COMPACT_BITS 0
+#endif
+
+#if NUM_SYM < 2
+#define CARD_BITS 1
+#elif NUM_SYM < 4
+#define CARD_BITS 2
+#elif NUM_SYM < 8
+#define CARD_BITS 3
+#elif NUM_SYM < 16
+#define CARD_BITS 4
+#elif NUM_SYM < 32
+#define CARD_BITS 5
+#else
+#define CARD_BITS 6
+#endif
+
+#if N <= 2
+#define POSITION_BITS 1
+#elif N <= 4
+#define POSITION_BITS 2
+#elif N <= 8
+#define POSITION_BITS 3
+#elif N <= 16
+#define POSITION_BITS 4
+#elif N <= 32
+#define POSITION_BITS 5
+#else
+#define POSITION_BITS 6
+#endif
+
+#if COMPACT_BITS && defined(__CPROVER__)
+typedef unsigned __CPROVER_bitvector[CARD_BITS] cardValue;
+typedef unsigned __CPROVER_bitvector[POSITION_BITS] positionValue;
+#if WEAK_SECURITY
+typedef unsigned __CPROVER_bitvector[1] probValue;
+#else
+typedef unsigned int probValue;
+#endif
+#else
+typedef unsigned int cardValue;
+typedef unsigned int positionValue;
+typedef unsigned int probValue;
+#endif
+
+cardValue nondet_card();
+positionValue nondet_position();
@@ -0,0 +1,545 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/**
+ * Enumerates all subgroups of the symmetric group S_n and writes them as catalogue
+ *   subgroups_N{n}.bin (read by the native search) and
+ *   subgroups_N{n}.h   (included by the symbolic programs via generatedTables.h).
+ * Closed shuffles are exactly these subgroups, such that the programs can select a closed
+ * shuffle by its index in the catalogue instead of checking its closedness on every step.
+ *
+ * Permutations are identified by their lexicographic rank among all permutations of
+ * 0..n-1, which is the permutation index used by the symbolic programs and the native search.
+ * The subgroups are sorted by their order and then by their (sorted) elements.
+ *
+ * Binary format (host byte order):
+ *   char     magic[4]        "SGRP"
+ *   uint32_t n
+ *   uint32_t count
+ *   uint32_t orders[count]
+ *   uint16_t elements[sum of all orders], the sorted ranks of each subgroup one after another
+ *
+ * Usage: generateSubgroups n [directory]
+ */
+
+#define MAX_CARDS 8
+
+/**
+ * Since we only need the header for small decks, larger catalogues are only written as binary.
+ */
+#define MAX_HEADER_CARDS 7
+
+#define MAX_GENERATORS 32
+
+unsigned int n;
+unsigned int groupOrder;
+unsigned char (*permutations)[MAX_CARDS];
+unsigned int *inverse;
+
+/**
+ * Random keys per permutation, the key of a subgroup is the sum over its elements.
+ */
+uint64_t *elementKeys;
+
+/**
+ * All subgroups found so far. The elements of subgroup i are stored sorted at
+ * pool[offsets[i]], ..., pool[offsets[i] + orders[i] - 1].
+ */
+unsigned int numberSubgroups;
+unsigned int capacitySubgroups;
+unsigned int *orders;
+size_t *offsets;
+uint64_t *keys;
+uint16_t *pool;
+size_t poolSize;
+size_t poolCapacity;
+
+/**
+ * Open addressing hash table from subgroup keys to subgroup indices (+1, 0 is empty).
+ */
+unsigned int *hashTable;
+size_t hashCapacity;
+
+/**
+ * One representative per conjugacy class, together with a set of generators.
+ */
+struct representative {
+    unsigned int subgroup;
+    unsigned int numberGenerators;
+    unsigned int generators[MAX_GENERATORS];
+};
+struct representative *representatives;
+unsigned int numberRepresentatives;
+unsigned int capacityRepresentatives;
+
+unsigned int rankPermutation(const unsigned char arr[MAX_CARDS]) {
+    unsigned int rank = 0;
+    for (unsigned int i = 0; i < n; i++) {
+        unsigned int smaller = 0;
+        for (unsigned int j = i + 1; j < n; j++) {
+            smaller += (arr[j] < arr[i]);
+        }
+        rank = rank * (n - i) + smaller;
+    }
+    return rank;
+}
+
+/**
+ * Rank of the permutation which first applies b and then a.
+ */
+unsigned int multiply(unsigned int a, unsigned int b) {
+    unsigned char result[MAX_CARDS];
+    for (unsigned int k = 0; k < n; k++) {
+        result[k] = permutations[a][permutations[b][k]];
+    }
+    return rankPermutation(result);
+}
+
+unsigned int conjugate(unsigned int x, unsigned int g) {
+    return multiply(multiply(x, g), inverse[x]);
+}
+
+unsigned int isEven(unsigned int p) {
+    unsigned int inversions = 0;
+    for (unsigned int i = 0; i < n; i++) {
+        for (unsigned int j = i + 1; j < n; j++) {
+            inversions += (permutations[p][j] < permutations[p][i]);
+        }
+    }
+    return !(inversions & 1);
+}
+
+void initPermutations() {
+    groupOrder = 1;
+    for (unsigned int i = 2; i <= n; i++) {
+        groupOrder *= i;
+    }
+    permutations = malloc(groupOrder * sizeof(*permutations));
+    inverse = malloc(groupOrder * sizeof(unsigned int));
+    elementKeys = malloc(groupOrder * sizeof(uint64_t));
+    unsigned char arr[MAX_CARDS];
+    for (unsigned int i = 0; i < n; i++) {
+        arr[i] = i;
+    }
+    // Permutations in lexicographic order, such that index and rank coincide.
+    for (unsigned int p = 0; p < groupOrder; p++) {
+        memcpy(permutations[p], arr, n);
+        unsigned int i = n - 1;
+        while (i > 0 && arr[i - 1] >= arr[i]) {
+            i--;
+        }
+        if (i == 0) {
+            break;
+        }
+        unsigned int j = n - 1;
+        while (arr[j] <= arr[i - 1]) {
+            j--;
+        }
+        unsigned char tmp = arr[i - 1];
+        arr[i - 1] = arr[j];
+        arr[j] = tmp;
+        for (unsigned int k = i, m = n - 1; k < m; k++, m--) {
+            tmp = arr[k];
+            arr[k] = arr[m];
+            arr[m] = tmp;
+        }
+    }
+    uint64_t seed = 0x9e3779b97f4a7c15ull;
+    for (unsigned int p = 0; p < groupOrder; p++) {
+        unsigned char inv[MAX_CARDS];
+        for (unsigned int k = 0; k < n; k++) {
+            inv[permutations[p][k]] = k;
+        }
+        inverse[p] = rankPermutation(inv);
+        // splitmix64
+        seed += 0x9e3779b97f4a7c15ull;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        elementKeys[p] = z ^ (z >> 31);
+    }
+}
+
+int compareUint16(const void *a, const void *b) {
+    uint16_t x = *(const uint16_t *)a;
+    uint16_t y = *(const uint16_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Returns the index of the subgroup with the given sorted elements, or numberSubgroups.
+ */
+unsigned int findSubgroup(const uint16_t *elements, unsigned int order, uint64_t key) {
+    for (size_t h = key & (hashCapacity - 1); hashTable[h]; h = (h + 1) & (hashCapacity - 1)) {
+        unsigned int i = hashTable[h] - 1;
+        if (keys[i] == key && orders[i] == order
+            && !memcmp(&pool[offsets[i]], elements, order * sizeof(uint16_t))) {
+            return i;
+        }
+    }
+    return numberSubgroups;
+}
+
+void insertHash(unsigned int index) {
+    if (2 * (numberSubgroups + 1) > hashCapacity) {
+        free(hashTable);
+        hashCapacity *= 2;
+        hashTable = calloc(hashCapacity, sizeof(unsigned int));
+        for (unsigned int i = 0; i < numberSubgroups; i++) {
+            if (i == index) {
+                continue;
+            }
+            size_t h = keys[i] & (hashCapacity - 1);
+            while (hashTable[h]) {
+                h = (h + 1) & (hashCapacity - 1);
+            }
+            hashTable[h] = i + 1;
+        }
+    }
+    size_t h = keys[index] & (hashCapacity - 1);
+    while (hashTable[h]) {
+        h = (h + 1) & (hashCapacity - 1);
+    }
+    hashTable[h] = index + 1;
+}
+
+/**
+ * Stores a new subgroup with the given sorted elements and returns its index.
+ */
+unsigned int addSubgroup(const uint16_t *elements, unsigned int order, uint64_t key) {
+    if (numberSubgroups == capacitySubgroups) {
+        capacitySubgroups = capacitySubgroups ? 2 * capacitySubgroups : 1024;
+        orders = realloc(orders, capacitySubgroups * sizeof(unsigned int));
+        offsets = realloc(offsets, capacitySubgroups * sizeof(size_t));
+        keys = realloc(keys, capacitySubgroups * sizeof(uint64_t));
+    }
+    while (poolSize + order > poolCapacity) {
+        poolCapacity = poolCapacity ? 2 * poolCapacity : 1 << 16;
+        pool = realloc(pool, poolCapacity * sizeof(uint16_t));
+    }
+    orders[numberSubgroups] = order;
+    offsets[numberSubgroups] = poolSize;
+    keys[numberSubgroups] = key;
+    memcpy(&pool[poolSize], elements, order * sizeof(uint16_t));
+    poolSize += order;
+    insertHash(numberSubgroups);
+    return numberSubgroups++;
+}
+
+/**
+ * Computes the group generated by the given generators into elements (unsorted) and
+ * returns its order. member must be cleared and is cleared again before returning.
+ * If bailout is set, the computation stops as soon as the group is larger than (n-1)!.
+ * For n >= 5, every subgroup of S_n with index less than n is A_n or S_n, so 0 is returned
+ * in this case and the caller decides by the parity of the generators.
+ */
+unsigned int closure(const unsigned int *generators, unsigned int numberGenerators,
+                     uint16_t *elements, unsigned char *member, unsigned int bailout) {
+    unsigned int order = 1;
+    elements[0] = 0;
+    member[0] = 1;
+    for (unsigned int i = 0; i < order; i++) {
+        for (unsigned int g = 0; g < numberGenerators; g++) {
+            unsigned int p = multiply(elements[i], generators[g]);
+            if (!member[p]) {
+                member[p] = 1;
+                elements[order++] = p;
+            }
+        }
+        if (bailout && n >= 5 && order > groupOrder / n) {
+            order = 0;
+            break;
+        }
+    }
+    for (unsigned int i = 0; i < groupOrder; i++) {
+        member[i] = 0;
+    }
+    return order;
+}
+
+/**
+ * Computes the normalizer of the subgroup generated by the given generators and with
+ * the given members. Returns its order, the elements are stored in normalizer.
+ */
+unsigned int computeNormalizer(const unsigned int *generators, unsigned int numberGenerators,
+                               const unsigned char *member, unsigned int *normalizer) {
+    unsigned int order = 0;
+    for (unsigned int x = 0; x < groupOrder; x++) {
+        unsigned int normalizes = 1;
+        for (unsigned int g = 0; normalizes && g < numberGenerators; g++) {
+            normalizes = member[conjugate(x, generators[g])];
+        }
+        if (normalizes) {
+            normalizer[order++] = x;
+        }
+    }
+    return order;
+}
+
+/**
+ * Adds the subgroup with the given (sorted) elements and generators as representative
+ * of a new conjugacy class, together with all of its conjugates.
+ */
+void addConjugacyClass(const uint16_t *elements, unsigned int order,
+                       const unsigned int *generators, unsigned int numberGenerators,
+                       unsigned char *member, unsigned char *covered, unsigned int *normalizer,
+                       uint16_t *buffer) {
+    for (unsigned int i = 0; i < order; i++) {
+        member[elements[i]] = 1;
+    }
+    unsigned int normalizerOrder = computeNormalizer(generators, numberGenerators, member,
+                                                     normalizer);
+    for (unsigned int i = 0; i < order; i++) {
+        member[elements[i]] = 0;
+    }
+
+    unsigned int first = numberSubgroups;
+    // Conjugating with x and y leads to the same subgroup iff x and y lie in the same
+    // left coset of the normalizer, so we take one x per coset.
+    for (unsigned int x = 0; x < groupOrder; x++) {
+        if (covered[x]) {
+            continue;
+        }
+        uint64_t key = 0;
+        for (unsigned int i = 0; i < order; i++) {
+            buffer[i] = conjugate(x, elements[i]);
+            key += elementKeys[buffer[i]];
+        }
+        qsort(buffer, order, sizeof(uint16_t), compareUint16);
+        addSubgroup(buffer, order, key);
+        for (unsigned int i = 0; i < normalizerOrder; i++) {
+            covered[multiply(x, normalizer[i])] = 1;
+        }
+    }
+    memset(covered, 0, groupOrder);
+
+    if (numberRepresentatives == capacityRepresentatives) {
+        capacityRepresentatives = capacityRepresentatives ? 2 * capacityRepresentatives : 64;
+        representatives = realloc(representatives,
+                                  capacityRepresentatives * sizeof(struct representative));
+    }
+    struct representative *rep = &representatives[numberRepresentatives++];
+    rep->subgroup = first;
+    rep->numberGenerators = numberGenerators;
+    memcpy(rep->generators, generators, numberGenerators * sizeof(unsigned int));
+}
+
+/**
+ * Every nontrivial subgroup K is generated by a maximal subgroup M of K and one further
+ * element g. Hence, we extend the representative H of every conjugacy class by all
+ * elements g outside of H. Since <H, hg> = <H, g> for h in H and <H, ygy^-1> = y<H, g>y^-1
+ * for y in the normalizer of H, only one coset Hg per orbit of the normalizer is extended.
+ */
+void enumerateSubgroups() {
+    unsigned char *member = calloc(groupOrder, 1);
+    unsigned char *inSubgroup = calloc(groupOrder, 1);
+    unsigned char *done = calloc(groupOrder, 1);
+    unsigned char *covered = calloc(groupOrder, 1);
+    unsigned int *normalizer = malloc(groupOrder * sizeof(unsigned int));
+    unsigned int *normalizerGenerators = malloc(groupOrder * sizeof(unsigned int));
+    unsigned int *queue = malloc(groupOrder * sizeof(unsigned int));
+    uint16_t *elements = malloc(groupOrder * sizeof(uint16_t));
+    uint16_t *buffer = malloc(groupOrder * sizeof(uint16_t));
+    unsigned int alternatingGroup = 0, symmetricGroup = 0;
+
+    hashCapacity = 1024;
+    hashTable = calloc(hashCapacity, sizeof(unsigned int));
+    uint16_t identity = 0;
+    addConjugacyClass(&identity, 1, NULL, 0, member, covered, normalizer, buffer);
+
+    for (unsigned int r = 0; r < numberRepresentatives; r++) {
+        struct representative rep = representatives[r];
+        unsigned int order = orders[rep.subgroup];
+        const uint16_t *subgroup = &pool[offsets[rep.subgroup]];
+        unsigned int evenGenerators = 1;
+        for (unsigned int g = 0; g < rep.numberGenerators; g++) {
+            evenGenerators &= isEven(rep.generators[g]);
+        }
+        for (unsigned int i = 0; i < order; i++) {
+            inSubgroup[subgroup[i]] = 1;
+        }
+        unsigned int normalizerOrder = computeNormalizer(rep.generators, rep.numberGenerators,
+                                                         inSubgroup, normalizer);
+        // A small generating set of the normalizer for the orbit computation below.
+        unsigned int numberNormalizerGenerators = 0;
+        for (unsigned int i = 0; i < normalizerOrder; i++) {
+            if (!member[normalizer[i]]) {
+                normalizerGenerators[numberNormalizerGenerators++] = normalizer[i];
+                unsigned int size = closure(normalizerGenerators, numberNormalizerGenerators,
+                                            elements, member, 0);
+                for (unsigned int j = 0; j < size; j++) {
+                    member[elements[j]] = 1;
+                }
+            }
+        }
+        memset(member, 0, groupOrder);
+
+        for (unsigned int g = 1; g < groupOrder; g++) {
+            if (done[g] || inSubgroup[g]) {
+                continue;
+            }
+            if (rep.numberGenerators == MAX_GENERATORS) {
+                fprintf(stderr, "Too many generators.\n");
+                exit(1);
+            }
+            unsigned int generators[MAX_GENERATORS];
+            memcpy(generators, rep.generators, rep.numberGenerators * sizeof(unsigned int));
+            generators[rep.numberGenerators] = g;
+            unsigned int numberGenerators = rep.numberGenerators + 1;
+            unsigned int size = closure(generators, numberGenerators, elements, member, 1);
+            unsigned int isNew = 1;
+            if (!size) {
+                unsigned int *known = (evenGenerators && isEven(g)) ? &alternatingGroup
+                                                                     : &symmetricGroup;
+                isNew = !*known;
+                *known = 1;
+                if (isNew) {
+                    size = closure(generators, numberGenerators, elements, member, 0);
+                }
+            }
+            if (isNew) {
+                uint64_t key = 0;
+                for (unsigned int i = 0; i < size; i++) {
+                    key += elementKeys[elements[i]];
+                }
+                qsort(elements, size, sizeof(uint16_t), compareUint16);
+                if (findSubgroup(elements, size, key) == numberSubgroups) {
+                    addConjugacyClass(elements, size, generators, numberGenerators,
+                                      member, covered, normalizer, buffer);
+                    // The pool may have been moved.
+                    subgroup = &pool[offsets[rep.subgroup]];
+                    normalizerOrder = computeNormalizer(rep.generators, rep.numberGenerators,
+                                                        inSubgroup, normalizer);
+                }
+            }
+
+            // Mark the orbit of the coset Hg under conjugation with the normalizer.
+            unsigned int head = 0, tail = 0;
+            queue[tail++] = g;
+            for (unsigned int i = 0; i < order; i++) {
+                done[multiply(subgroup[i], g)] = 1;
+            }
+            while (head < tail) {
+                unsigned int c = queue[head++];
+                for (unsigned int y = 0; y < numberNormalizerGenerators; y++) {
+                    unsigned int d = conjugate(normalizerGenerators[y], c);
+                    if (!done[d]) {
+                        queue[tail++] = d;
+                        for (unsigned int i = 0; i < order; i++) {
+                            done[multiply(subgroup[i], d)] = 1;
+                        }
+                    }
+                }
+            }
+        }
+        memset(done, 0, groupOrder);
+        for (unsigned int i = 0; i < order; i++) {
+            inSubgroup[subgroup[i]] = 0;
+        }
+    }
+    free(member);
+    free(inSubgroup);
+    free(done);
+    free(covered);
+    free(normalizer);
+    free(normalizerGenerators);
+    free(queue);
+    free(elements);
+    free(buffer);
+}
+
+int compareSubgroups(const void *a, const void *b) {
+    unsigned int x = *(const unsigned int *)a;
+    unsigned int y = *(const unsigned int *)b;
+    if (orders[x] != orders[y]) {
+        return (orders[x] > orders[y]) - (orders[x] < orders[y]);
+    }
+    return memcmp(&pool[offsets[x]], &pool[offsets[y]], orders[x] * sizeof(uint16_t)) < 0
+           ? -1 : (x != y);
+}
+
+unsigned int writeCatalogue(const char *directory, const unsigned int *sorted) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/subgroups_N%u.bin", directory, n);
+    FILE *out = fopen(path, "wb");
+    if (!out) {
+        fprintf(stderr, "Cannot write %s.\n", path);
+        return 0;
+    }
+    uint32_t header[2] = { n, numberSubgroups };
+    fwrite("SGRP", 1, 4, out);
+    fwrite(header, sizeof(uint32_t), 2, out);
+    for (unsigned int i = 0; i < numberSubgroups; i++) {
+        uint32_t order = orders[sorted[i]];
+        fwrite(&order, sizeof(uint32_t), 1, out);
+    }
+    for (unsigned int i = 0; i < numberSubgroups; i++) {
+        fwrite(&pool[offsets[sorted[i]]], sizeof(uint16_t), orders[sorted[i]], out);
+    }
+    fclose(out);
+
+    if (n > MAX_HEADER_CARDS) {
+        return 1;
+    }
+    snprintf(path, sizeof(path), "%s/subgroups_N%u.h", directory, n);
+    out = fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "Cannot write %s.\n", path);
+        return 0;
+    }
+    fprintf(out, "/**\n * Generated by generateSubgroups.c, do not edit.\n");
+    fprintf(out, " * All subgroups of S_%u sorted by their order, the elements are given as\n", n);
+    fprintf(out, " * indices of the lexicographically sorted permutations.\n */\n");
+    fprintf(out, "#ifndef SUBGROUPS_N%u_H\n#define SUBGROUPS_N%u_H\n\n", n, n);
+    fprintf(out, "#define SUBGROUP_CATALOGUE_N %u\n", n);
+    fprintf(out, "#define NUMBER_SUBGROUPS %u\n", numberSubgroups);
+    fprintf(out, "#define NUMBER_SUBGROUP_ELEMENTS %zu\n\n", poolSize);
+    fprintf(out, "const unsigned int subgroupOrders[%u] = {", numberSubgroups);
+    for (unsigned int i = 0; i < numberSubgroups; i++) {
+        fprintf(out, "%s%u", (i % 16) ? ", " : (i ? ",\n    " : "\n    "), orders[sorted[i]]);
+    }
+    fprintf(out, "\n};\n\nconst unsigned int subgroupOffsets[%u] = {", numberSubgroups);
+    size_t offset = 0;
+    for (unsigned int i = 0; i < numberSubgroups; i++) {
+        fprintf(out, "%s%zu", (i % 16) ? ", " : (i ? ",\n    " : "\n    "), offset);
+        offset += orders[sorted[i]];
+    }
+    fprintf(out, "\n};\n\nconst unsigned int subgroupElements[%zu] = {", poolSize);
+    size_t written = 0;
+    for (unsigned int i = 0; i < numberSubgroups; i++) {
+        const uint16_t *elements = &pool[offsets[sorted[i]]];
+        for (unsigned int j = 0; j < orders[sorted[i]]; j++, written++) {
+            fprintf(out, "%s%u", (written % 16) ? ", " : (written ? ",\n    " : "\n    "),
+                    elements[j]);
+        }
+    }
+    fprintf(out, "\n};\n\n#endif\n");
+    fclose(out);
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s n [directory]\n", argv[0]);
+        return 1;
+    }
+    n = atoi(argv[1]);
+    const char *directory = argc > 2 ? argv[2] : ".";
+    if (n < 1 || n > MAX_CARDS) {
+        fprintf(stderr, "Only subgroups of S_1, ..., S_%u are supported.\n", MAX_CARDS);
+        return 1;
+    }
+    initPermutations();
+    enumerateSubgroups();
+
+    unsigned int *sorted = malloc(numberSubgroups * sizeof(unsigned int));
+    for (unsigned int i = 0; i < numberSubgroups; i++) {
+        sorted[i] = i;
+    }
+    qsort(sorted, numberSubgroups, sizeof(unsigned int), compareSubgroups);
+    printf("S_%u has %u subgroups in %u conjugacy classes.\n",
+           n, numberSubgroups, numberRepresentatives);
+    return !writeCatalogue(directory, sorted);
+}
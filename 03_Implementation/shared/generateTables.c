@@ -0,0 +1,294 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Writes the sequences and permutations, which getEmptyState() and getStateWithAllPermutations()
+ * otherwise construct nondeterministically, as constant arrays into the headers
+ *   sequences_N{n}_S{sym}.h and permutations_N{n}.h
+ * Additionally, the index of the sequence resulting from applying any permutation to any
+ * sequence is written as action table into actions_N{n}_S{sym}.h, such that doShuffle()
+ * only needs one lookup per pair of sequence and permutation, and the composition of any two
+ * permutations as in combinePermutations() is written as Cayley table into cayley_N{n}.h.
+ * The symbolic programs include these headers via generatedTables.h whenever they are available.
+ *
+ * Usage: generateTables n numSym [directory]
+ */
+
+#define MAX_CARDS 10
+
+/**
+ * Larger action and Cayley tables are not written, since the symbolic programs cannot
+ * handle such decks.
+ */
+#define MAX_TABLE_ENTRIES (1 << 20)
+
+/**
+ * Rearranges arr into the lexicographically next arrangement of its values.
+ * Returns 0 iff arr already was the last arrangement.
+ */
+unsigned int nextArrangement(unsigned int arr[], unsigned int length) {
+    if (length < 2) {
+        return 0;
+    }
+    unsigned int i = length - 1;
+    while (i > 0 && arr[i - 1] >= arr[i]) {
+        i--;
+    }
+    if (i == 0) {
+        return 0;
+    }
+    unsigned int j = length - 1;
+    while (arr[j] <= arr[i - 1]) {
+        j--;
+    }
+    unsigned int tmp = arr[i - 1];
+    arr[i - 1] = arr[j];
+    arr[j] = tmp;
+    for (unsigned int k = i, m = length - 1; k < m; k++, m--) {
+        tmp = arr[k];
+        arr[k] = arr[m];
+        arr[m] = tmp;
+    }
+    return 1;
+}
+
+/**
+ * Counts all arrangements of the given (sorted) array.
+ */
+unsigned long countArrangements(unsigned int arr[], unsigned int n) {
+    unsigned int copy[MAX_CARDS];
+    unsigned long count = 0;
+    for (unsigned int i = 0; i < n; i++) {
+        copy[i] = arr[i];
+    }
+    do {
+        count++;
+    } while (nextArrangement(copy, n));
+    return count;
+}
+
+/**
+ * Writes all arrangements of arr as the constant array `name` into the given header.
+ */
+unsigned int writeTable(const char *path, const char *guard, const char *name,
+                        const char *availableMacro, const char *description,
+                        unsigned int arr[], unsigned int n) {
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "Cannot write %s.\n", path);
+        return 0;
+    }
+    unsigned long count = countArrangements(arr, n);
+    fprintf(out, "/**\n * Generated by generateTables.c, do not edit.\n");
+    fprintf(out, " * %s, sorted lexicographically.\n */\n", description);
+    fprintf(out, "#ifndef %s\n#define %s\n\n", guard, guard);
+    fprintf(out, "#define %s %lu\n\n", availableMacro, count);
+    fprintf(out, "const unsigned int %s[%lu][%u] = {\n", name, count, n);
+    do {
+        fprintf(out, "    { ");
+        for (unsigned int i = 0; i < n; i++) {
+            fprintf(out, "%s%u", i ? ", " : "", arr[i]);
+        }
+        fprintf(out, " },\n");
+    } while (nextArrangement(arr, n));
+    fprintf(out, "};\n\n#endif\n");
+    fclose(out);
+    return 1;
+}
+
+/**
+ * Stores all arrangements of the given (sorted) array into table, row by row.
+ */
+void collectArrangements(unsigned int arr[], unsigned int n, unsigned int *table) {
+    unsigned int copy[MAX_CARDS];
+    for (unsigned int i = 0; i < n; i++) {
+        copy[i] = arr[i];
+    }
+    unsigned long count = 0;
+    do {
+        for (unsigned int i = 0; i < n; i++) {
+            table[count * n + i] = copy[i];
+        }
+        count++;
+    } while (nextArrangement(copy, n));
+}
+
+/**
+ * Index of the given arrangement in the lexicographically sorted table.
+ */
+unsigned long findArrangement(const unsigned int *arr, const unsigned int *table,
+                              unsigned long count, unsigned int n) {
+    unsigned long low = 0, high = count;
+    while (low + 1 < high) {
+        unsigned long mid = (low + high) / 2;
+        if (memcmp(&table[mid * n], arr, n * sizeof(unsigned int)) <= 0) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/**
+ * Writes the index of the sequence that results from applying permutation p to sequence s
+ * as actionTable[p][s]. As in doShuffle(), permutation p moves the card at position k to
+ * position (permutation value - 1).
+ */
+unsigned int writeActionTable(const char *path, const char *guard, unsigned int deck[],
+                              unsigned int n) {
+    unsigned int identity[MAX_CARDS];
+    for (unsigned int i = 0; i < n; i++) {
+        identity[i] = i + 1;
+    }
+    unsigned long numberSequences = countArrangements(deck, n);
+    unsigned long numberPermutations = countArrangements(identity, n);
+    if (numberSequences * numberPermutations > MAX_TABLE_ENTRIES) {
+        return 1;
+    }
+    unsigned int *sequences = malloc(numberSequences * n * sizeof(unsigned int));
+    unsigned int *permutations = malloc(numberPermutations * n * sizeof(unsigned int));
+    collectArrangements(deck, n, sequences);
+    collectArrangements(identity, n, permutations);
+
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "Cannot write %s.\n", path);
+        free(sequences);
+        free(permutations);
+        return 0;
+    }
+    fprintf(out, "/**\n * Generated by generateTables.c, do not edit.\n");
+    fprintf(out, " * Index of the sequence resulting from applying permutation p to sequence s,\n");
+    fprintf(out, " * both given by their indices in the lexicographically sorted tables.\n */\n");
+    fprintf(out, "#ifndef %s\n#define %s\n\n", guard, guard);
+    fprintf(out, "#define ACTION_TABLE_PERMUTATIONS %lu\n", numberPermutations);
+    fprintf(out, "#define ACTION_TABLE_SEQUENCES %lu\n\n", numberSequences);
+    fprintf(out, "const unsigned int actionTable[%lu][%lu] = {\n",
+            numberPermutations, numberSequences);
+    for (unsigned long p = 0; p < numberPermutations; p++) {
+        fprintf(out, "    {");
+        for (unsigned long i = 0; i < numberSequences; i++) {
+            unsigned int result[MAX_CARDS];
+            for (unsigned int k = 0; k < n; k++) {
+                result[permutations[p * n + k] - 1] = sequences[i * n + k];
+            }
+            fprintf(out, "%s%lu", i ? ", " : " ",
+                    findArrangement(result, sequences, numberSequences, n));
+        }
+        fprintf(out, " },\n");
+    }
+    fprintf(out, "};\n\n#endif\n");
+    fclose(out);
+    free(sequences);
+    free(permutations);
+    return 1;
+}
+
+/**
+ * Writes the index of combinePermutations(a, b) as cayleyTable[a][b], i.e., of the permutation
+ * r with r[a[k]] = b[k] for all positions k (with permutation values counted from 0).
+ */
+unsigned int writeCayleyTable(const char *path, const char *guard, unsigned int n) {
+    unsigned int identity[MAX_CARDS];
+    for (unsigned int i = 0; i < n; i++) {
+        identity[i] = i;
+    }
+    unsigned long numberPermutations = countArrangements(identity, n);
+    if (numberPermutations * numberPermutations > MAX_TABLE_ENTRIES) {
+        return 1;
+    }
+    unsigned int *permutations = malloc(numberPermutations * n * sizeof(unsigned int));
+    collectArrangements(identity, n, permutations);
+
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "Cannot write %s.\n", path);
+        free(permutations);
+        return 0;
+    }
+    fprintf(out, "/**\n * Generated by generateTables.c, do not edit.\n");
+    fprintf(out, " * Index of combinePermutations(a, b) for the permutations with indices a and b.\n");
+    fprintf(out, " */\n#ifndef %s\n#define %s\n\n", guard, guard);
+    fprintf(out, "#define CAYLEY_TABLE_N %u\n\n", n);
+    fprintf(out, "const unsigned int cayleyTable[%lu][%lu] = {\n",
+            numberPermutations, numberPermutations);
+    for (unsigned long a = 0; a < numberPermutations; a++) {
+        fprintf(out, "    {");
+        for (unsigned long b = 0; b < numberPermutations; b++) {
+            unsigned int result[MAX_CARDS];
+            for (unsigned int k = 0; k < n; k++) {
+                result[permutations[a * n + k]] = permutations[b * n + k];
+            }
+            fprintf(out, "%s%lu", b ? ", " : " ",
+                    findArrangement(result, permutations, numberPermutations, n));
+        }
+        fprintf(out, " },\n");
+    }
+    fprintf(out, "};\n\n#endif\n");
+    fclose(out);
+    free(permutations);
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s n numSym [directory]\n", argv[0]);
+        return 1;
+    }
+    unsigned int n = atoi(argv[1]);
+    unsigned int numSym = atoi(argv[2]);
+    const char *directory = argc > 3 ? argv[3] : ".";
+    if (n < 2 || n > MAX_CARDS || numSym < 2 || numSym > n) {
+        fprintf(stderr, "Unsupported deck with %u cards and %u symbols.\n", n, numSym);
+        return 1;
+    }
+
+    // As in the scripts, every symbol occurs n / numSym times and the last one takes the rest.
+    unsigned int arr[MAX_CARDS];
+    unsigned int pos = 0;
+    for (unsigned int s = 1; s <= numSym; s++) {
+        unsigned int count = (s < numSym) ? n / numSym : n - (numSym - 1) * (n / numSym);
+        for (unsigned int j = 0; j < count; j++) {
+            arr[pos++] = s;
+        }
+    }
+    unsigned int deck[MAX_CARDS];
+    memcpy(deck, arr, sizeof(deck));
+    char path[4096];
+    char guard[64];
+    char description[128];
+    snprintf(path, sizeof(path), "%s/sequences_N%u_S%u.h", directory, n, numSym);
+    snprintf(guard, sizeof(guard), "SEQUENCES_N%u_S%u_H", n, numSym);
+    snprintf(description, sizeof(description),
+             "All sequences of %u cards with %u distinct symbols", n, numSym);
+    if (!writeTable(path, guard, "sequenceTable", "SEQUENCE_TABLE_SIZE", description, arr, n)) {
+        return 1;
+    }
+
+    // Permutations are stored as in getStateWithAllPermutations(), i.e., with values 1..n.
+    for (unsigned int i = 0; i < n; i++) {
+        arr[i] = i + 1;
+    }
+    snprintf(path, sizeof(path), "%s/permutations_N%u.h", directory, n);
+    snprintf(guard, sizeof(guard), "PERMUTATIONS_N%u_H", n);
+    snprintf(description, sizeof(description), "All permutations of %u cards", n);
+    if (!writeTable(path, guard, "permutationTable", "PERMUTATION_TABLE_SIZE",
+                    description, arr, n)) {
+        return 1;
+    }
+
+    snprintf(path, sizeof(path), "%s/actions_N%u_S%u.h", directory, n, numSym);
+    snprintf(guard, sizeof(guard), "ACTIONS_N%u_S%u_H", n, numSym);
+    if (!writeActionTable(path, guard, deck, n)) {
+        return 1;
+    }
+
+    snprintf(path, sizeof(path), "%s/cayley_N%u.h", directory, n);
+    snprintf(guard, sizeof(guard), "CAYLEY_N%u_H", n);
+    if (!writeCayleyTable(path, guard, n)) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,52 @@
+#!/bin/bash
+
+# Writes the constant sequence and permutation tables for n cards and numSym symbols as well
+# as the catalogue of all subgroups of S_n into the folder generated/ next to this script.
+# The symbolic programs include them via generatedTables.h, and fall back to nondeterministic
+# tables if they are missing.
+# Usage: ./generateTables.sh n numSym
+
+CC='gcc'
+DIR=`dirname "$0"`
+N=$1
+NUM_SYM=$2
+GENERATED=$DIR"/generated"
+GENERATOR=$GENERATED"/generateTables"
+SUBGROUP_GENERATOR=$GENERATED"/generateSubgroups"
+
+if [[ $N == "" ]] || [[ $NUM_SYM == "" ]]
+then
+    echo -e "Usage: generateTables.sh n numSym"
+    exit
+fi
+
+SEQUENCES=$GENERATED"/sequences_N"$N"_S"$NUM_SYM".h"
+if [ $SEQUENCES -nt $DIR"/generateTables.c" ] && [ -f $GENERATED"/subgroups_N"$N".bin" ]
+then
+    exit
+fi
+
+if ! [ -x "$(command -v $CC)" ]
+then
+    echo -e $CC" is not available, the symbolic programs use nondeterministic tables."
+    exit
+fi
+
+mkdir -p $GENERATED
+if [ ! -x $GENERATOR ] || [ $DIR"/generateTables.c" -nt $GENERATOR ]
+then
+    $CC -O2 $DIR"/generateTables.c" -o $GENERATOR || exit
+fi
+if [ ! $SEQUENCES -nt $DIR"/generateTables.c" ]
+then
+    $GENERATOR $N $NUM_SYM $GENERATED
+fi
+
+if [ ! -f $GENERATED"/subgroups_N"$N".bin" ]
+then
+    if [ ! -x $SUBGROUP_GENERATOR ] || [ $DIR"/generateSubgroups.c" -nt $SUBGROUP_GENERATOR ]
+    then
+        $CC -O2 $DIR"/generateSubgroups.c" -o $SUBGROUP_GENERATOR || exit
+    fi
+    $SUBGROUP_GENERATOR $N $GENERATED
+fi
@@ -0,0 +1,66 @@
+/**
+ * Includes the constant sequence, permutation and action tables as well as the subgroup catalogue
+ * written by generateTables.sh for the current N and NUM_SYM, if they exist.
+ * With these tables, getEmptyState() and getStateWithAllPermutations() assign constants
+ * instead of constraining nondeterministic values, which removes all of these values (and
+ * their ordering constraints) from the formula. doShuffle() looks up the resulting sequence
+ * of every permutation in the action table instead of permuting the cards and ranking the
+ * result, and applyShuffle() chooses closed shuffles by their subgroup index instead of
+ * checking the closedness of the permutation set. Where closedness is still checked, the
+ * compositions of permutations are looked up in the Cayley table.
+ * Without the tables, the programs fall back to the nondeterministic assignments.
+ */
+
+#define TABLE_STRING(x) #x
+#define TABLE_HEADER(x) TABLE_STRING(x)
+#define SEQUENCE_HEADER(n, s) TABLE_HEADER(generated/sequences_N##n##_S##s.h)
+#define SEQUENCE_TABLE(n, s) SEQUENCE_HEADER(n, s)
+#define PERMUTATION_HEADER(n) TABLE_HEADER(generated/permutations_N##n.h)
+#define PERMUTATION_TABLE(n) PERMUTATION_HEADER(n)
+#define ACTION_HEADER(n, s) TABLE_HEADER(generated/actions_N##n##_S##s.h)
+#define ACTION_TABLE(n, s) ACTION_HEADER(n, s)
+#define CAYLEY_HEADER(n) TABLE_HEADER(generated/cayley_N##n.h)
+#define CAYLEY_TABLE(n) CAYLEY_HEADER(n)
+#define SUBGROUP_HEADER(n) TABLE_HEADER(generated/subgroups_N##n.h)
+#define SUBGROUP_TABLE(n) SUBGROUP_HEADER(n)
+
+#if defined(__has_include)
+#if __has_include(SEQUENCE_TABLE(N, NUM_SYM))
+#include SEQUENCE_TABLE(N, NUM_SYM)
+#endif
+#if __has_include(ACTION_TABLE(N, NUM_SYM))
+#include ACTION_TABLE(N, NUM_SYM)
+#endif
+#if __has_include(PERMUTATION_TABLE(N))
+#include PERMUTATION_TABLE(N)
+#endif
+#if (CLOSED_PROTOCOL || FORCE_RANDOM_CUTS) && __has_include(CAYLEY_TABLE(N))
+#include CAYLEY_TABLE(N)
+#endif
+#if CLOSED_PROTOCOL && !FORCE_RANDOM_CUTS && __has_include(SUBGROUP_TABLE(N))
+#include SUBGROUP_TABLE(N)
+#endif
+#endif
+
+/**
+ * The tables are only used if they match the sizes given to the program.
+ */
+#if defined(SEQUENCE_TABLE_SIZE) && SEQUENCE_TABLE_SIZE == NUMBER_POSSIBLE_SEQUENCES
+#define USE_SEQUENCE_TABLE 1
+#endif
+
+#if defined(PERMUTATION_TABLE_SIZE) && PERMUTATION_TABLE_SIZE == NUMBER_POSSIBLE_PERMUTATIONS
+#define USE_PERMUTATION_TABLE 1
+#endif
+
+#if defined(ACTION_TABLE_SEQUENCES) && ACTION_TABLE_SEQUENCES == NUMBER_POSSIBLE_SEQUENCES
+#define USE_ACTION_TABLE 1
+#endif
+
+#if defined(CAYLEY_TABLE_N) && CAYLEY_TABLE_N == N
+#define USE_CAYLEY_TABLE 1
+#endif
+
+#if defined(SUBGROUP_CATALOGUE_N) && SUBGROUP_CATALOGUE_N == N
+#define USE_SUBGROUP_TABLE 1
+#endif
@@ -0,0 +1,277 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Structured record of a found protocol, written by the native search and by the driver
+ * (from the decoded CBMC trace), such that later tools load a protocol without parsing any
+ * trace. Positions, observations and branches are counted from 0 as in the models, and
+ * permutations are given by their lexicographic rank among all permutations of N cards.
+ * A state is the bitset of its possible sequences, where bit i of word i / 64 stands for the
+ * sequence with index i in the models.
+ *
+ * Binary format (host byte order):
+ *   char     magic[4]        "PREC"
+ *   uint32_t version         PROTOCOL_RECORD_VERSION
+ *   uint32_t n, numSym
+ *   uint32_t maxLength       the bound L of the search
+ *   uint32_t engine          RECORD_ENGINE_CBMC or RECORD_ENGINE_NATIVE
+ *   double   seconds         time of the search
+ *   uint32_t optionsLength
+ *   char     options[optionsLength], the further options of the run (not terminated)
+ *   uint32_t numberResults
+ *   uint32_t results[numberResults], the positions encoding the output bits in pairs
+ *   uint32_t sequenceWords   words of a state, 0 if the states are not known
+ *   uint64_t startState[sequenceWords]
+ *   uint32_t length          number of actions
+ *   per action:
+ *     uint32_t type, position, branch, permSetSize
+ *     uint32_t permutations[permSetSize], for a module its cards (commitments, then helpers)
+ *     uint64_t state[sequenceWords], the state after the action (in the observed branch)
+ */
+
+#define PROTOCOL_RECORD_VERSION 1
+
+#define RECORD_ENGINE_CBMC 0
+#define RECORD_ENGINE_NATIVE 1
+
+/**
+ * Action types, equal to TURN, SHUFFLE and PROTOCOL of the models.
+ */
+#define RECORD_TURN 0
+#define RECORD_SHUFFLE 1
+#define RECORD_PROTOCOL 2
+
+#define MAX_RECORD_RESULTS 4
+
+struct recordAction {
+    unsigned int type;
+    /**
+     * Turned position, or the chosen module for RECORD_PROTOCOL.
+     */
+    unsigned int position;
+    /**
+     * Observed symbol minus one after a turn, or the end state of a module.
+     */
+    unsigned int branch;
+    /**
+     * Permutation ranks of a shuffle, or the cards of a module.
+     */
+    unsigned int permSetSize;
+    unsigned int *permutations;
+    uint64_t *state;
+};
+
+struct protocolRecord {
+    unsigned int n;
+    unsigned int numSym;
+    unsigned int maxLength;
+    unsigned int engine;
+    double seconds;
+    char *options;
+    unsigned int numberResults;
+    unsigned int results[MAX_RECORD_RESULTS];
+    unsigned int sequenceWords;
+    uint64_t *startState;
+    unsigned int length;
+    struct recordAction *actions;
+};
+
+void initProtocolRecord(struct protocolRecord *record) {
+    memset(record, 0, sizeof(struct protocolRecord));
+}
+
+void freeProtocolRecord(struct protocolRecord *record) {
+    for (unsigned int i = 0; i < record->length; i++) {
+        free(record->actions[i].permutations);
+        free(record->actions[i].state);
+    }
+    free(record->actions);
+    free(record->startState);
+    free(record->options);
+    initProtocolRecord(record);
+}
+
+void writeWords(FILE *out, const uint32_t *words, size_t count) {
+    fwrite(words, sizeof(uint32_t), count, out);
+}
+
+/**
+ * Writes the record to path. It is written to a temporary file first and then renamed,
+ * such that readers never see a partial record. Returns 1 on success.
+ */
+unsigned int writeProtocolRecord(const char *path, const struct protocolRecord *record) {
+    char temporary[4096];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+    FILE *out = fopen(temporary, "wb");
+    if (!out) {
+        fprintf(stderr, "Cannot write %s.\n", temporary);
+        return 0;
+    }
+    uint32_t optionsLength = record->options ? (uint32_t)strlen(record->options) : 0;
+    uint32_t header[] = { PROTOCOL_RECORD_VERSION, record->n, record->numSym,
+                          record->maxLength, record->engine };
+    fwrite("PREC", 1, 4, out);
+    writeWords(out, header, 5);
+    fwrite(&record->seconds, sizeof(double), 1, out);
+    writeWords(out, &optionsLength, 1);
+    fwrite(record->options, 1, optionsLength, out);
+    uint32_t numberResults = record->numberResults;
+    writeWords(out, &numberResults, 1);
+    for (unsigned int i = 0; i < record->numberResults; i++) {
+        uint32_t result = record->results[i];
+        writeWords(out, &result, 1);
+    }
+    uint32_t sequenceWords = record->sequenceWords;
+    writeWords(out, &sequenceWords, 1);
+    fwrite(record->startState, sizeof(uint64_t), sequenceWords, out);
+    uint32_t length = record->length;
+    writeWords(out, &length, 1);
+    for (unsigned int i = 0; i < record->length; i++) {
+        const struct recordAction *action = &record->actions[i];
+        uint32_t fields[] = { action->type, action->position, action->branch,
+                              action->permSetSize };
+        writeWords(out, fields, 4);
+        for (unsigned int j = 0; j < action->permSetSize; j++) {
+            uint32_t permutation = action->permutations[j];
+            writeWords(out, &permutation, 1);
+        }
+        fwrite(action->state, sizeof(uint64_t), sequenceWords, out);
+    }
+    unsigned int written = !ferror(out);
+    written &= !fclose(out);
+    if (!written || rename(temporary, path)) {
+        fprintf(stderr, "Cannot write %s.\n", path);
+        remove(temporary);
+        return 0;
+    }
+    return 1;
+}
+
+unsigned int readWord(FILE *in, unsigned int *value) {
+    uint32_t word;
+    if (fread(&word, sizeof(uint32_t), 1, in) != 1) {
+        return 0;
+    }
+    *value = word;
+    return 1;
+}
+
+/**
+ * Reads the record at path into record. Returns 1 on success, otherwise the record is empty.
+ */
+unsigned int readProtocolRecord(const char *path, struct protocolRecord *record) {
+    initProtocolRecord(record);
+    FILE *in = fopen(path, "rb");
+    if (!in) {
+        return 0;
+    }
+    char magic[4];
+    unsigned int version, optionsLength;
+    unsigned int valid = fread(magic, 1, 4, in) == 4 && !memcmp(magic, "PREC", 4)
+                         && readWord(in, &version) && version == PROTOCOL_RECORD_VERSION
+                         && readWord(in, &record->n) && readWord(in, &record->numSym)
+                         && readWord(in, &record->maxLength) && readWord(in, &record->engine)
+                         && fread(&record->seconds, sizeof(double), 1, in) == 1
+                         && readWord(in, &optionsLength) && optionsLength < (1u << 20);
+    if (valid) {
+        record->options = calloc(optionsLength + 1, 1);
+        valid = fread(record->options, 1, optionsLength, in) == optionsLength
+                && readWord(in, &record->numberResults)
+                && record->numberResults <= MAX_RECORD_RESULTS;
+    }
+    for (unsigned int i = 0; valid && i < record->numberResults; i++) {
+        valid = readWord(in, &record->results[i]);
+    }
+    valid = valid && readWord(in, &record->sequenceWords) && record->sequenceWords < (1u << 24);
+    if (valid) {
+        record->startState = calloc(record->sequenceWords + 1, sizeof(uint64_t));
+        valid = fread(record->startState, sizeof(uint64_t), record->sequenceWords, in)
+                == record->sequenceWords;
+    }
+    unsigned int length = 0;
+    valid = valid && readWord(in, &length) && length < (1u << 16);
+    if (valid) {
+        record->actions = calloc(length + 1, sizeof(struct recordAction));
+    }
+    for (unsigned int i = 0; valid && i < length; i++) {
+        struct recordAction *action = &record->actions[i];
+        record->length++;
+        valid = readWord(in, &action->type) && readWord(in, &action->position)
+                && readWord(in, &action->branch) && readWord(in, &action->permSetSize)
+                && action->permSetSize < (1u << 24);
+        if (valid) {
+            action->permutations = malloc((action->permSetSize + 1) * sizeof(unsigned int));
+            action->state = calloc(record->sequenceWords + 1, sizeof(uint64_t));
+        }
+        for (unsigned int j = 0; valid && j < action->permSetSize; j++) {
+            valid = readWord(in, &action->permutations[j]);
+        }
+        valid = valid && fread(action->state, sizeof(uint64_t), record->sequenceWords, in)
+                         == record->sequenceWords;
+    }
+    fclose(in);
+    if (!valid) {
+        freeProtocolRecord(record);
+    }
+    return valid;
+}
+
+void printRecordState(FILE *out, const uint64_t *state, unsigned int sequenceWords) {
+    fprintf(out, "[");
+    for (unsigned int w = 0; w < sequenceWords; w++) {
+        fprintf(out, "%s\"0x%016llx\"", w ? ", " : "", (unsigned long long)state[w]);
+    }
+    fprintf(out, "]");
+}
+
+/**
+ * Writes the record as one JSON object. States are given as arrays of their words.
+ */
+void printProtocolRecordJson(FILE *out, const struct protocolRecord *record) {
+    static const char *types[] = { "TURN", "SHUFFLE", "PROTOCOL" };
+    fprintf(out, "{\"n\": %u, \"numSym\": %u, \"maxLength\": %u, \"engine\": \"%s\", "
+            "\"seconds\": %.3f, \"options\": \"", record->n, record->numSym, record->maxLength,
+            record->engine == RECORD_ENGINE_NATIVE ? "native" : "cbmc", record->seconds);
+    for (const char *c = record->options ? record->options : ""; *c; c++) {
+        fprintf(out, (*c == '"' || *c == '\\') ? "\\%c" : "%c", *c);
+    }
+    fprintf(out, "\", \"results\": [");
+    for (unsigned int i = 0; i < record->numberResults; i++) {
+        fprintf(out, "%s%u", i ? ", " : "", record->results[i]);
+    }
+    fprintf(out, "]");
+    if (record->sequenceWords) {
+        fprintf(out, ", \"startState\": ");
+        printRecordState(out, record->startState, record->sequenceWords);
+    }
+    fprintf(out, ", \"actions\": [");
+    for (unsigned int i = 0; i < record->length; i++) {
+        const struct recordAction *action = &record->actions[i];
+        fprintf(out, "%s\n  {\"type\": \"%s\"", i ? "," : "",
+                action->type < 3 ? types[action->type] : "NONE");
+        if (action->type == RECORD_TURN) {
+            fprintf(out, ", \"position\": %u, \"observation\": %u",
+                    action->position, action->branch);
+        } else if (action->type == RECORD_SHUFFLE) {
+            fprintf(out, ", \"permutations\": [");
+            for (unsigned int j = 0; j < action->permSetSize; j++) {
+                fprintf(out, "%s%u", j ? ", " : "", action->permutations[j]);
+            }
+            fprintf(out, "]");
+        } else if (action->type == RECORD_PROTOCOL) {
+            fprintf(out, ", \"module\": %u, \"cards\": [", action->position);
+            for (unsigned int j = 0; j < action->permSetSize; j++) {
+                fprintf(out, "%s%u", j ? ", " : "", action->permutations[j]);
+            }
+            fprintf(out, "], \"endState\": %u", action->branch);
+        }
+        if (record->sequenceWords) {
+            fprintf(out, ", \"state\": ");
+            printRecordState(out, action->state, record->sequenceWords);
+        }
+        fprintf(out, "}");
+    }
+    fprintf(out, "%s]}\n", record->length ? "\n" : "");
+}
@@ -0,0 +1,92 @@
+/**
+ * Deterministic ranking and unranking of sequences and permutations.
+ *
+ * All states store their sequences sorted lexicographically (see getEmptyState()), hence the
+ * index of a sequence equals its lexicographic rank among all arrangements of the same cards.
+ * The rank is computed in O(N * NUM_SYM) arithmetic operations and without any nondeterminism,
+ * such that this file can be included by the symbolic programs and by the native search alike.
+ * The including program must define N, NUM_SYM and NUMBER_POSSIBLE_SEQUENCES.
+ *
+ * The number of arrangements of the remaining cards that start with symbol s is
+ * arrangements * count[s] / length, which is always an integer. Since all loop bounds
+ * are constants, CBMC unrolls all loops and only has to divide by constants.
+ */
+
+/**
+ * Lexicographic rank of arr among all arrangements of its values, where the values range
+ * from firstSymbol to firstSymbol + numSymbols - 1 and there are `arrangements` such arrangements.
+ */
+unsigned int rankArrangement(const unsigned int arr[N], unsigned int firstSymbol,
+                             unsigned int numSymbols, unsigned int arrangements) {
+    unsigned int count[N + 1];
+    for (unsigned int s = 0; s < numSymbols; s++) {
+        count[s] = 0;
+        for (unsigned int i = 0; i < N; i++) {
+            count[s] += (arr[i] == firstSymbol + s);
+        }
+    }
+
+    unsigned int rank = 0;
+    for (unsigned int i = 0; i < N; i++) {
+        unsigned int length = N - i;
+        unsigned int chosenCount = 0;
+        for (unsigned int s = 0; s < numSymbols; s++) {
+            unsigned int symbol = firstSymbol + s;
+            if (symbol < arr[i]) {
+                // Skip all arrangements that continue with a smaller symbol.
+                rank += arrangements * count[s] / length;
+            } else if (symbol == arr[i]) {
+                chosenCount = count[s];
+                count[s]--;
+            }
+        }
+        arrangements = arrangements * chosenCount / length;
+    }
+    return rank;
+}
+
+/**
+ * Inverse of rankArrangement(): writes the arrangement with the given rank into arr,
+ * where count[s] is the number of cards with value firstSymbol + s.
+ */
+void unrankArrangement(unsigned int rank, const unsigned int count[], unsigned int firstSymbol,
+                       unsigned int numSymbols, unsigned int arrangements, unsigned int arr[N]) {
+    unsigned int remaining[N + 1];
+    for (unsigned int s = 0; s < numSymbols; s++) {
+        remaining[s] = count[s];
+    }
+    for (unsigned int i = 0; i < N; i++) {
+        unsigned int length = N - i;
+        unsigned int chosen = 0;
+        for (unsigned int s = 0; s < numSymbols; s++) {
+            unsigned int block = arrangements * remaining[s] / length;
+            if (!chosen && rank < block) {
+                chosen = 1;
+                arr[i] = firstSymbol + s;
+                remaining[s]--;
+                arrangements = block;
+            } else if (!chosen) {
+                rank -= block;
+            }
+        }
+    }
+}
+
+/**
+ * Index of the given sequence (with card symbols 1..NUM_SYM) in any state.
+ */
+unsigned int getSequenceRank(const unsigned int arr[N]) {
+    return rankArrangement(arr, 1, NUM_SYM, NUMBER_POSSIBLE_SEQUENCES);
+}
+
+/**
+ * Index of the given permutation in the lexicographically sorted list of all permutations,
+ * where the permutation maps card position k to position arr[k] (counting from 0).
+ */
+unsigned int getPermutationRank(const unsigned int arr[N]) {
+    unsigned int arrangements = 1;
+    for (unsigned int i = 2; i <= N; i++) {
+        arrangements *= i;
+    }
+    return rankArrangement(arr, 0, N, arrangements);
+}